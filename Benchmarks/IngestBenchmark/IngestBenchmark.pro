@@ -0,0 +1,25 @@
+# Headless benchmark of the telemetry ingest path:
+# serial bytes -> TelemetryIngest (LineFramer -> TelemetryParser/BinaryTelemetry) -> SpscRing
+
+TEMPLATE = app
+TARGET   = IngestBenchmark
+CONFIG  += console c++17 release
+CONFIG  -= qt app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../telemetryingest.cpp \
+    ../../latencystats.cpp \
+    ../../lineframer.cpp \
+    ../../telemetryparser.cpp \
+    ../../binarytelemetry.cpp
+
+HEADERS += \
+    ../../telemetryingest.h \
+    ../../latencystats.h \
+    ../../lineframer.h \
+    ../../telemetryparser.h \
+    ../../binarytelemetry.h \
+    ../../spscring.h
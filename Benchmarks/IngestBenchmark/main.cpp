@@ -0,0 +1,319 @@
+// Feeds a recorded (or synthetic) serial byte stream through the same
+// path SerialReader::onReadyRead() follows, without any widget, and for
+// every input chunk size reports:
+//   lines/s, ns/line  throughput of a pass without any instrumentation
+//   allocs/line       operator new calls during that pass
+//   p50..max          time needed to absorb a single chunk (copy, frame,
+//                     parse and publish every record it completes)
+//
+// A recorded stream is simply what the Buggy sends, e.g.
+//   cat /dev/ttyACM0 > buggy.raw
+// It may switch to the binary framing exactly as SerialReader does.
+
+#include "telemetryingest.h"
+#include "binarytelemetry.h"
+#include "latencystats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+
+static std::atomic<unsigned long long> nAllocations(0);
+
+
+void*
+operator new(size_t size) {
+    nAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+
+void*
+operator new[](size_t size) {
+    return operator new(size);
+}
+
+
+void
+operator delete(void* p) noexcept {
+    free(p);
+}
+
+
+void
+operator delete[](void* p) noexcept {
+    free(p);
+}
+
+
+void
+operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+
+void
+operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+
+namespace {
+
+
+inline double
+now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return double(ts.tv_sec) + 1.0e-9*double(ts.tv_nsec);
+}
+
+
+// The same records (and proportions) the Buggy firmware sends
+std::string
+syntheticStream(size_t nLines, bool bBinary) {
+    std::string stream("Buggy Ready\n");
+    if(bBinary)
+        stream += "Buggy Binary\n";
+    char line[160];
+    for(size_t i=0; i<nLines; i++) {
+        double t = 0.01*double(i);
+        TelemetryFrame frame;
+        frame.fields = TelemetryFrame::Attitude | TelemetryFrame::Motors | TelemetryFrame::Time;
+        frame.q0 = float(cos(0.05*t));
+        frame.q1 = 0.0f;
+        frame.q2 = 0.0f;
+        frame.q3 = float(sin(0.05*t));
+        frame.leftSpeed  = round(150.0 + 20.0*sin(t))/100.0;
+        frame.leftPath   = double(i*7);
+        frame.rightSpeed = round(-150.0 + 20.0*cos(t))/100.0;
+        frame.rightPath  = -double(i*7);
+        frame.obstacleDistance = 0.0;
+        frame.dTime = double(i*10);
+        if((i % 10) == 0) {
+            frame.fields |= TelemetryFrame::Obstacle;
+            frame.obstacleDistance = round(100.0 + 50.0*sin(0.2*t));
+        }
+        if(bBinary) {
+            unsigned char buffer[BinaryTelemetry::maxEncodedSize];
+            stream.append(reinterpret_cast<const char*>(buffer),
+                          BinaryTelemetry::encode(frame, buffer));
+            continue;
+        }
+        int size = snprintf(line, sizeof(line),
+                            "A,%ld,%ld,%ld,%ld,M,%ld,%ld,%ld,%ld,",
+                            lround(frame.q0*1000.0), lround(frame.q1*1000.0),
+                            lround(frame.q2*1000.0), lround(frame.q3*1000.0),
+                            lround(frame.leftSpeed*100.0), lround(frame.leftPath),
+                            lround(frame.rightSpeed*100.0), lround(frame.rightPath));
+        if(frame.fields & TelemetryFrame::Obstacle)
+            size += snprintf(line+size, sizeof(line)-size_t(size),
+                             "D,%ld,", lround(frame.obstacleDistance));
+        size += snprintf(line+size, sizeof(line)-size_t(size),
+                         "T,%ld\n", lround(frame.dTime));
+        stream.append(line, size_t(size));
+    }
+    return stream;
+}
+
+
+bool
+readFile(const char* pFileName, std::string* pStream) {
+    FILE* pFile = fopen(pFileName, "rb");
+    if(!pFile) {
+        perror(pFileName);
+        return false;
+    }
+    char buffer[65536];
+    size_t nRead;
+    while((nRead = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+        pStream->append(buffer, nRead);
+    fclose(pFile);
+    return true;
+}
+
+
+// SerialReader without Qt: the same TelemetryIngest, fed from memory,
+// and the consumer side of the ring drained after every commit, as the
+// GUI would do at its own pace.
+class Ingest
+{
+public:
+    Ingest()
+        : ingest(&ring)
+        , checksum(0.0)
+    {
+        ingest.setBinaryRequested(true);
+    }
+
+    void reset() {
+        ingest.reset();
+    }
+
+    void absorb(const char* pData, size_t size) {
+        while(size) {
+            size_t nFree;
+            char* pFree = ingest.writeBuffer(&nFree);
+            if(nFree > size)
+                nFree = size;
+            memcpy(pFree, pData, nFree);
+            ingest.commit(nFree, monotonicNs());
+            ingest.takeReply(); // The "B\n" would go to the Buggy
+            drain();
+            pData += nFree;
+            size  -= nFree;
+        }
+    }
+
+    unsigned long long frames() const {
+        return ingest.framesReceived();
+    }
+
+    unsigned long long corrupted() const {
+        return ingest.corruptedRecords();
+    }
+
+    double sum() const {
+        return checksum;
+    }
+
+protected:
+    void drain() {
+        const TelemetryFrame* pConsumed;
+        while((pConsumed = ring.front()) != nullptr) {
+            if(pConsumed->fields & TelemetryFrame::Motors)
+                checksum += pConsumed->leftPath; // Keep the parsing observable
+            ring.pop();
+        }
+    }
+
+private:
+    TelemetryRing      ring;
+    TelemetryIngest    ingest;
+    double             checksum;
+};
+
+
+double
+percentile(std::vector<double>* pSamples, double fraction) {
+    if(pSamples->empty())
+        return 0.0;
+    size_t n = size_t(fraction*double(pSamples->size()-1));
+    std::nth_element(pSamples->begin(), pSamples->begin()+long(n), pSamples->end());
+    return (*pSamples)[n];
+}
+
+
+void
+usage(const char* pName) {
+    fprintf(stderr,
+            "Usage: %s [-f file] [-n lines] [-b] [-r repeats]\n"
+            "  -f file     recorded serial stream (default: synthetic)\n"
+            "  -n lines    synthetic records (default 200000)\n"
+            "  -b          synthetic stream in binary framing\n"
+            "  -r repeats  throughput passes per chunk size (default 3, best kept)\n",
+            pName);
+}
+
+
+} // namespace
+
+
+int
+main(int argc, char* argv[]) {
+    const char* pFileName = nullptr;
+    size_t nLines = 200000;
+    bool bBinary = false;
+    int nRepeats = 3;
+    for(int i=1; i<argc; i++) {
+        if(!strcmp(argv[i], "-f") && (i+1 < argc))
+            pFileName = argv[++i];
+        else if(!strcmp(argv[i], "-n") && (i+1 < argc))
+            nLines = size_t(atol(argv[++i]));
+        else if(!strcmp(argv[i], "-b"))
+            bBinary = true;
+        else if(!strcmp(argv[i], "-r") && (i+1 < argc))
+            nRepeats = std::max(1, atoi(argv[++i]));
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::string stream;
+    if(pFileName) {
+        if(!readFile(pFileName, &stream))
+            return 1;
+    }
+    else {
+        stream = syntheticStream(nLines, bBinary);
+    }
+    const char* pData = stream.data();
+    const size_t size = stream.size();
+
+    Ingest* pIngest = new Ingest(); // Too big for the stack
+    std::vector<double> chunkTimes;
+    chunkTimes.reserve(size+1);
+
+    printf("# %s: %zu bytes\n", pFileName ? pFileName : "synthetic stream", size);
+    printf("%8s %12s %10s %12s %10s %10s %10s %10s\n",
+           "chunk", "lines/s", "ns/line", "allocs/line",
+           "p50[us]", "p99[us]", "p99.9[us]", "max[us]");
+    for(size_t chunk=1; chunk<=65536; chunk*=4) {
+        // Throughput: no instrumentation inside the loop
+        double best = 1.0e30;
+        unsigned long long nFrames = 0;
+        unsigned long long allocations = 0;
+        for(int iRepeat=0; iRepeat<nRepeats; iRepeat++) {
+            pIngest->reset();
+            unsigned long long framesBefore = pIngest->frames();
+            unsigned long long allocationsBefore = nAllocations.load();
+            double t0 = now();
+            for(size_t pos=0; pos<size; pos+=chunk)
+                pIngest->absorb(pData+pos, std::min(chunk, size-pos));
+            double elapsed = now()-t0;
+            allocations = nAllocations.load()-allocationsBefore;
+            nFrames = pIngest->frames()-framesBefore;
+            best = std::min(best, elapsed);
+        }
+        if(nFrames == 0) {
+            fprintf(stderr, "No telemetry records found\n");
+            return 1;
+        }
+
+        // Latency: time spent on every single chunk
+        chunkTimes.clear();
+        pIngest->reset();
+        for(size_t pos=0; pos<size; pos+=chunk) {
+            double t0 = now();
+            pIngest->absorb(pData+pos, std::min(chunk, size-pos));
+            chunkTimes.push_back(now()-t0);
+        }
+        double maxTime = *std::max_element(chunkTimes.begin(), chunkTimes.end());
+
+        printf("%8zu %12.0f %10.1f %12.4f %10.3f %10.3f %10.3f %10.3f\n",
+               chunk,
+               double(nFrames)/best,
+               1.0e9*best/double(nFrames),
+               double(allocations)/double(nFrames),
+               1.0e6*percentile(&chunkTimes, 0.5),
+               1.0e6*percentile(&chunkTimes, 0.99),
+               1.0e6*percentile(&chunkTimes, 0.999),
+               1.0e6*maxTime);
+    }
+    if(pIngest->corrupted())
+        printf("# %llu corrupted binary records\n", pIngest->corrupted());
+    printf("# checksum %.0f\n", pIngest->sum());
+    delete pIngest;
+    return 0;
+}
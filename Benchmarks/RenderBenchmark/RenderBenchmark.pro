@@ -0,0 +1,49 @@
+# Frame times of the Plot2D drawing (PlotRenderer) into an offscreen
+# QImage. Runs without a display:
+#   QT_QPA_PLATFORM=offscreen ./RenderBenchmark -c render.csv
+# and of the OpenGL backend (Plot2DGLRenderer) into a framebuffer object,
+# on the software rasterizer too:
+#   LIBGL_ALWAYS_SOFTWARE=1 ./RenderBenchmark -g -q
+# With -w also of the Plot2D widget paintEvent() (layer caches, strip
+# chart scrolling), rendered into the same QImage.
+
+TEMPLATE = app
+TARGET   = RenderBenchmark
+QT      += core gui widgets
+CONFIG  += console c++17 release
+CONFIG  -= app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../plot2d.cpp \
+    ../../plot2dgl.cpp \
+    ../../axesdialog.cpp \
+    ../../plotpropertiesdlg.cpp \
+    ../../plotrenderer.cpp \
+    ../../datastream2d.cpp \
+    ../../DataSetProperties.cpp \
+    ../../AxisLimits.cpp \
+    ../../AxisFrame.cpp \
+    ../../plot2dglrenderer.cpp \
+    ../../screentransform.cpp \
+    ../../minmaxpyramid.cpp \
+    ../../multichannelstream.cpp
+
+HEADERS += \
+    ../../plot2d.h \
+    ../../plot2dgl.h \
+    ../../axesdialog.h \
+    ../../plotpropertiesdlg.h \
+    ../../plotrenderer.h \
+    ../../datastream2d.h \
+    ../../DataSetProperties.h \
+    ../../AxisLimits.h \
+    ../../AxisFrame.h \
+    ../../plot2dglrenderer.h \
+    ../../screentransform.h \
+    ../../minmaxpyramid.h \
+    ../../multichannelstream.h
+
+RESOURCES += ../../shaders.qrc
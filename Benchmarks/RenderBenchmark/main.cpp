@@ -0,0 +1,452 @@
+// Renders a plot into an offscreen QImage through PlotRenderer, the
+// drawing of Plot2D without its layer caches, from scratch at every
+// frame, over a matrix of
+//   series      number of Data Sets drawn
+//   points      samples per Data Set
+//   symbol      iline, ipoint, iplus, icircle, ...
+//   axes        lin-lin or log-log
+//   size        of the image, in pixels
+// and for every case reports the median and the best ms/frame and the
+// points/s of the median frame. Use -c and -j to keep the results (CSV
+// or JSON) and compare two versions of the draw path.
+// With -w the Plot2D widget itself is painted too (render() into the
+// QImage runs its paintEvent()): as a plot with fixed limits, where the
+// frame and the ticks come from the cached static layer, and as a strip
+// chart receiving 1% of its samples before every frame, where only the
+// scrolled-in segments are drawn (lin-lin only).
+// With -g the lines and points are drawn instead by the OpenGL backend
+// (Plot2DGLRenderer, the drawing of Plot2DGLLayer) into a framebuffer
+// object over an offscreen surface; it doubles as a smoke test, failing
+// when nothing is drawn. It runs on Mesa llvmpipe with
+// LIBGL_ALWAYS_SOFTWARE=1.
+
+#include "plotrenderer.h"
+#include "plot2d.h"
+#include "plot2dglrenderer.h"
+#include "datastream2d.h"
+
+#include <QApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QImage>
+#include <QPainter>
+#include <QFont>
+#include <QList>
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+
+namespace {
+
+
+inline double
+now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return double(ts.tv_sec) + 1.0e-9*double(ts.tv_nsec);
+}
+
+
+struct Symbol {
+    const char* name;
+    int id;
+};
+
+
+struct Axes {
+    const char* name;
+    bool bLog;
+};
+
+
+struct Result {
+    const char* path;
+    int nSeries;
+    int nPoints;
+    const char* symbol;
+    const char* axes;
+    int width;
+    int height;
+    double msMedian;
+    double msBest;
+    double pointsPerSecond;
+};
+
+
+// A noisy, positive signal, so that log axes can be used too
+void
+fillSeries(DataStream2D* pData, int nPoints, int seed) {
+    std::vector<double> x(size_t(nPoints)), y(size_t(nPoints));
+    srand(unsigned(seed));
+    for(int i=0; i<nPoints; i++) {
+        x[size_t(i)] = 0.001*double(i+1);
+        y[size_t(i)] = 2.0 + sin(0.01*double(i)+double(seed)) + 0.2*double(rand())/RAND_MAX;
+    }
+    pData->setMaxPoints(nPoints);
+    pData->AddPoints(x.data(), y.data(), nPoints);
+}
+
+
+QList<DataStream2D*>
+makeDataSets(int nSeries, int nPoints, const Symbol& symbol) {
+    QList<DataStream2D*> dataSets;
+    for(int s=0; s<nSeries; s++) {
+        DataStream2D* pData = new DataStream2D(s+1, 1, QColor::fromHsv((47*s) % 360, 255, 255),
+                                               symbol.id, QString("Series %1").arg(s+1));
+        fillSeries(pData, nPoints, s);
+        pData->SetShow(true);
+        pData->SetShowTitle(true);
+        dataSets.append(pData);
+    }
+    return dataSets;
+}
+
+
+void
+setTimes(Result* pResult, std::vector<double>* pTimes) {
+    std::sort(pTimes->begin(), pTimes->end());
+    double median = (*pTimes)[pTimes->size()/2];
+    pResult->msMedian = 1.0e3*median;
+    pResult->msBest   = 1.0e3*pTimes->front();
+    pResult->pointsPerSecond = double(pResult->nSeries)*double(pResult->nPoints)/median;
+}
+
+
+Result
+runCase(int nSeries, int nPoints, const Symbol& symbol, const Axes& axes,
+        QSize size, int nFrames)
+{
+    QList<DataStream2D*> dataSets = makeDataSets(nSeries, nPoints, symbol);
+    PlotRenderer renderer;
+    renderer.SetPlotTitle("Render Benchmark");
+    for(DataStream2D* pData : dataSets)
+        renderer.AddDataSet(pData);
+    // Fixed limits: the autoscale is not what is measured
+    renderer.SetLimits(0.001, 0.001*nPoints, 0.5, 4.0, false, false, axes.bLog, axes.bLog);
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    QFont font(QString("Ubuntu"), 10, QFont::Bold);
+    std::vector<double> times;
+    for(int frame=-2; frame<nFrames; frame++) { // Two warm up frames
+        double t0 = now();
+        QPainter painter(&image);
+        painter.setFont(font);
+        renderer.Render(&painter, size, Qt::black);
+        painter.end();
+        if(frame >= 0)
+            times.push_back(now()-t0);
+    }
+    qDeleteAll(dataSets);
+
+    Result result;
+    result.path     = "painter";
+    result.nSeries  = nSeries;
+    result.nPoints  = nPoints;
+    result.symbol   = symbol.name;
+    result.axes     = axes.name;
+    result.width    = size.width();
+    result.height   = size.height();
+    setTimes(&result, &times);
+    return result;
+}
+
+
+// The same plot, as the Plot2D widget draws it at every paintEvent().
+// A strip chart spans the whole ring and receives new samples before
+// every frame (not timed).
+Result
+runWidgetCase(bool bStrip, int nSeries, int nPoints, const Symbol& symbol,
+              const Axes& axes, QSize size, int nFrames)
+{
+    Plot2D plot(nullptr, "Render Benchmark");
+    plot.resize(size);
+    plot.setMaxPoints(nPoints);
+    for(int s=0; s<nSeries; s++) {
+        DataStream2D* pData = plot.NewDataSet(s+1, 1, QColor::fromHsv((47*s) % 360, 255, 255),
+                                              symbol.id, QString("Series %1").arg(s+1));
+        fillSeries(pData, nPoints, s);
+        plot.SetShowDataSet(s+1, true);
+        plot.SetShowTitle(s+1, true);
+    }
+    plot.SetLimits(0.001, 0.001*nPoints, 0.5, 4.0, false, false, axes.bLog, axes.bLog);
+    if(bStrip)
+        plot.SetStripChart(true, 0.001*nPoints);
+
+    int nNew = qMax(1, nPoints/100);
+    std::vector<double> x(size_t(nNew)), y(size_t(nNew));
+    int nAdded = nPoints;
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    std::vector<double> times;
+    for(int frame=-2; frame<nFrames; frame++) { // Two warm up frames
+        if(bStrip) {
+            for(int i=0; i<nNew; i++) {
+                x[size_t(i)] = 0.001*double(nAdded+i+1);
+                y[size_t(i)] = 2.0 + sin(0.01*double(nAdded+i));
+            }
+            for(int s=0; s<nSeries; s++)
+                plot.NewPoints(s+1, x.data(), y.data(), nNew);
+            nAdded += nNew;
+        }
+        double t0 = now();
+        plot.render(&image);
+        if(frame >= 0)
+            times.push_back(now()-t0);
+    }
+
+    Result result;
+    result.path     = bStrip ? "strip" : "plot2d";
+    result.nSeries  = nSeries;
+    result.nPoints  = nPoints;
+    result.symbol   = symbol.name;
+    result.axes     = axes.name;
+    result.width    = size.width();
+    result.height   = size.height();
+    setTimes(&result, &times);
+    return result;
+}
+
+
+// The same axes as runCase(), mapped on the whole framebuffer.
+// The samples are uploaded at the warm up frames: the frames timed are
+// the draw calls alone (up to glFinish()).
+// False when the shaders cannot be built or nothing was drawn.
+bool
+runGLCase(QOpenGLContext* pContext, int nSeries, int nPoints, const Symbol& symbol,
+          const Axes& axes, QSize size, int nFrames, Result* pResult)
+{
+    QOpenGLFramebufferObject fbo(size);
+    if(!fbo.isValid() || !fbo.bind())
+        return false;
+    Plot2DGLRenderer renderer;
+    if(!renderer.initialize(pContext))
+        return false;
+    QList<DataStream2D*> dataSets = makeDataSets(nSeries, nPoints, symbol);
+    double xMin = 0.001, xMax = 0.001*nPoints;
+    double yMin = 0.5,   yMax = 4.0;
+    if(axes.bLog) {
+        xMin = log10(xMin); xMax = log10(xMax);
+        yMin = log10(yMin); yMax = log10(yMax);
+    }
+    AxisMapping xMap = { xMin, size.width()/(xMax-xMin), 0.0, axes.bLog };
+    AxisMapping yMap = { yMin, -size.height()/(yMax-yMin), double(size.height()), axes.bLog };
+    renderer.setMappings(xMap, yMap);
+    renderer.setSeries(dataSets);
+
+    QOpenGLFunctions* pFunctions = pContext->functions();
+    pFunctions->glViewport(0, 0, size.width(), size.height());
+    std::vector<double> times;
+    for(int frame=-2; frame<nFrames; frame++) { // Two warm up frames
+        double t0 = now();
+        renderer.render(size);
+        pFunctions->glFinish();
+        if(frame >= 0)
+            times.push_back(now()-t0);
+    }
+    QImage image = fbo.toImage();
+    bool bDrawn = false;
+    for(int y=0; (y<image.height()) && !bDrawn; y++) {
+        const QRgb* pLine = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for(int x=0; x<image.width(); x++) {
+            if(qAlpha(pLine[x]) != 0) {
+                bDrawn = true;
+                break;
+            }
+        }
+    }
+    renderer.deleteBuffers();
+    fbo.release();
+    qDeleteAll(dataSets);
+
+    pResult->path     = "gl";
+    pResult->nSeries  = nSeries;
+    pResult->nPoints  = nPoints;
+    pResult->symbol   = symbol.name;
+    pResult->axes     = axes.name;
+    pResult->width    = size.width();
+    pResult->height   = size.height();
+    setTimes(pResult, &times);
+    return bDrawn;
+}
+
+
+bool
+writeCsv(const char* pFileName, const std::vector<Result>& results) {
+    FILE* pFile = fopen(pFileName, "w");
+    if(!pFile)
+        return false;
+    fprintf(pFile, "path,series,points,symbol,axes,width,height,ms_median,ms_best,points_per_s\n");
+    for(const Result& r : results)
+        fprintf(pFile, "%s,%d,%d,%s,%s,%d,%d,%.4f,%.4f,%.0f\n",
+                r.path, r.nSeries, r.nPoints, r.symbol, r.axes, r.width, r.height,
+                r.msMedian, r.msBest, r.pointsPerSecond);
+    return fclose(pFile) == 0;
+}
+
+
+bool
+writeJson(const char* pFileName, const std::vector<Result>& results) {
+    FILE* pFile = fopen(pFileName, "w");
+    if(!pFile)
+        return false;
+    fprintf(pFile, "[\n");
+    for(size_t i=0; i<results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(pFile, "  {\"path\": \"%s\", \"series\": %d, \"points\": %d, \"symbol\": \"%s\", \"axes\": \"%s\", "
+                       "\"width\": %d, \"height\": %d, \"ms_median\": %.4f, \"ms_best\": %.4f, "
+                       "\"points_per_s\": %.0f}%s\n",
+                r.path, r.nSeries, r.nPoints, r.symbol, r.axes, r.width, r.height,
+                r.msMedian, r.msBest, r.pointsPerSecond, (i+1 < results.size()) ? "," : "");
+    }
+    fprintf(pFile, "]\n");
+    return fclose(pFile) == 0;
+}
+
+
+void
+usage(const char* pName) {
+    fprintf(stderr,
+            "Usage: %s [-r frames] [-q] [-g | -w] [-c file.csv] [-j file.json]\n"
+            "  -r frames  frames timed per case (default 20)\n"
+            "  -q         quick: a reduced matrix\n"
+            "  -g         the OpenGL backend (lines and points); fails when nothing is drawn\n"
+            "  -w         the Plot2D widget too, plain and as a strip chart\n"
+            "  -c file    results as CSV\n"
+            "  -j file    results as JSON\n"
+            "Without a display run it with QT_QPA_PLATFORM=offscreen\n"
+            "(-g needs an OpenGL context: LIBGL_ALWAYS_SOFTWARE=1 for Mesa llvmpipe)\n",
+            pName);
+}
+
+
+} // namespace
+
+
+int
+main(int argc, char* argv[]) {
+    QApplication application(argc, argv);
+    int nFrames = 20;
+    bool bQuick = false;
+    bool bGL    = false;
+    bool bWidget = false;
+    const char* pCsvName  = nullptr;
+    const char* pJsonName = nullptr;
+    for(int i=1; i<argc; i++) {
+        if(!strcmp(argv[i], "-r") && (i+1 < argc))
+            nFrames = std::max(1, atoi(argv[++i]));
+        else if(!strcmp(argv[i], "-q"))
+            bQuick = true;
+        else if(!strcmp(argv[i], "-g"))
+            bGL = true;
+        else if(!strcmp(argv[i], "-w"))
+            bWidget = true;
+        else if(!strcmp(argv[i], "-c") && (i+1 < argc))
+            pCsvName = argv[++i];
+        else if(!strcmp(argv[i], "-j") && (i+1 < argc))
+            pJsonName = argv[++i];
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Symbol> symbols = {
+        { "iline",       PlotRenderer::iline       },
+        { "ipoint",      PlotRenderer::ipoint      },
+        { "iplus",       PlotRenderer::iplus       },
+        { "iper",        PlotRenderer::iper        },
+        { "istar",       PlotRenderer::istar       },
+        { "iuptriangle", PlotRenderer::iuptriangle },
+        { "icircle",     PlotRenderer::icircle     }
+    };
+    const Axes axesList[] = {
+        { "lin-lin", false },
+        { "log-log", true  }
+    };
+    std::vector<int> seriesCounts = { 1, 4, 16 };
+    std::vector<int> pointCounts  = { 1000, 10000, 100000 };
+    std::vector<QSize> sizes = { QSize(640, 480), QSize(1920, 1080) };
+    if(bQuick) {
+        seriesCounts = { 1, 4 };
+        pointCounts  = { 1000, 20000 };
+        sizes = { QSize(800, 600) };
+    }
+    if(bGL) {
+        // What the OpenGL backend draws
+        symbols = {
+            { "iline",       PlotRenderer::iline       },
+            { "ipoint",      PlotRenderer::ipoint      }
+        };
+    }
+
+    QOffscreenSurface surface;
+    QOpenGLContext context;
+    if(bGL && bWidget) {
+        usage(argv[0]);
+        return 1;
+    }
+    if(bGL) {
+        surface.create();
+        if(!context.create() || !context.makeCurrent(&surface)) {
+            fprintf(stderr, "Unable to create an OpenGL context\n");
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    bool bFailed = false;
+    printf("# median of %d frames\n", nFrames);
+    printf("%-8s %6s %7s %-12s %-8s %10s %10s %10s %14s\n",
+           "path", "series", "points", "symbol", "axes", "size", "ms/frame", "best ms", "points/s");
+    for(const QSize& size : sizes) {
+        for(const Axes& axes : axesList) {
+            for(const Symbol& symbol : symbols) {
+                for(int nSeries : seriesCounts) {
+                    for(int nPoints : pointCounts) {
+                        Result r;
+                        if(!bGL) {
+                            r = runCase(nSeries, nPoints, symbol, axes, size, nFrames);
+                        }
+                        else if(!runGLCase(&context, nSeries, nPoints, symbol, axes, size, nFrames, &r)) {
+                            fprintf(stderr, "%d x %d %s %s: nothing drawn by OpenGL\n",
+                                    nSeries, nPoints, symbol.name, axes.name);
+                            bFailed = true;
+                            continue;
+                        }
+                        std::vector<Result> rows = { r };
+                        if(bWidget) {
+                            rows.push_back(runWidgetCase(false, nSeries, nPoints, symbol, axes, size, nFrames));
+                            if(!axes.bLog)
+                                rows.push_back(runWidgetCase(true, nSeries, nPoints, symbol, axes, size, nFrames));
+                        }
+                        for(const Result& row : rows) {
+                            results.push_back(row);
+                            printf("%-8s %6d %7d %-12s %-8s %4dx%-5d %10.3f %10.3f %14.0f\n",
+                                   row.path, row.nSeries, row.nPoints, row.symbol, row.axes,
+                                   row.width, row.height, row.msMedian, row.msBest, row.pointsPerSecond);
+                        }
+                        fflush(stdout);
+                    }
+                }
+            }
+        }
+    }
+    if(bGL)
+        context.doneCurrent();
+    if(pCsvName && !writeCsv(pCsvName, results)) {
+        fprintf(stderr, "Unable to write %s\n", pCsvName);
+        return 1;
+    }
+    if(pJsonName && !writeJson(pJsonName, results)) {
+        fprintf(stderr, "Unable to write %s\n", pJsonName);
+        return 1;
+    }
+    return bFailed ? 1 : 0;
+}
@@ -0,0 +1,15 @@
+# Microbenchmark of the Plot2D world to screen kernels (ScreenTransform)
+
+TEMPLATE = app
+TARGET   = TransformBenchmark
+CONFIG  += console c++17 release
+CONFIG  -= qt app_bundle
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../screentransform.cpp
+
+HEADERS += \
+    ../../screentransform.h
@@ -0,0 +1,121 @@
+// Times ScreenTransform::mapPoints() with every instruction set available
+// on this machine, on linear and logarithmic axes, against a plain loop
+// calling log10(). Reports ns/point, Mpoints/s and the largest pixel
+// difference from the reference.
+
+#include "screentransform.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+
+namespace {
+
+
+inline double
+now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return double(ts.tv_sec) + 1.0e-9*double(ts.tv_nsec);
+}
+
+
+void
+reference(const std::vector<double>& x, const std::vector<double>& y,
+          const AxisMapping& xMap, const AxisMapping& yMap, std::vector<double>* pXY)
+{
+    for(size_t i=0; i<x.size(); i++) {
+        double vx = xMap.bLog ? (x[i] > 0.0 ? log10(x[i]) : NAN) : x[i];
+        double vy = yMap.bLog ? (y[i] > 0.0 ? log10(y[i]) : NAN) : y[i];
+        (*pXY)[2*i]   = (vx-xMap.origin)*xMap.scale + xMap.offset;
+        (*pXY)[2*i+1] = (vy-yMap.origin)*yMap.scale + yMap.offset;
+    }
+}
+
+
+double
+maxDifference(const std::vector<double>& a, const std::vector<double>& b) {
+    double diff = 0.0;
+    for(size_t i=0; i<a.size(); i++) {
+        if(std::isnan(a[i]) != std::isnan(b[i]))
+            return INFINITY;
+        if(!std::isnan(a[i]))
+            diff = std::max(diff, fabs(a[i]-b[i]));
+    }
+    return diff;
+}
+
+
+} // namespace
+
+
+int
+main(int argc, char* argv[]) {
+    size_t nPoints = 100000;
+    int nRepeats = 50;
+    for(int i=1; i<argc; i++) {
+        if(!strcmp(argv[i], "-n") && (i+1 < argc))
+            nPoints = size_t(atol(argv[++i]));
+        else if(!strcmp(argv[i], "-r") && (i+1 < argc))
+            nRepeats = std::max(1, atoi(argv[++i]));
+        else {
+            fprintf(stderr, "Usage: %s [-n points] [-r repeats]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // A strip chart: time on X, a noisy positive signal on Y
+    std::vector<double> x(nPoints), y(nPoints);
+    srand(1);
+    for(size_t i=0; i<nPoints; i++) {
+        x[i] = 0.001*double(i+1);
+        y[i] = 1.0 + 100.0*double(rand())/RAND_MAX;
+    }
+    std::vector<double> expected(2*nPoints), result(2*nPoints);
+
+    struct Case {
+        const char* name;
+        bool bLogX;
+        bool bLogY;
+    } cases[] = {
+        { "lin-lin", false, false },
+        { "lin-log", false, true  },
+        { "log-log", true,  true  }
+    };
+
+    printf("# %zu points, best of %d\n", nPoints, nRepeats);
+    printf("%-8s %-8s %10s %12s %12s\n", "axes", "isa", "ns/point", "Mpoints/s", "max diff[px]");
+    for(const Case& c : cases) {
+        AxisMapping xMap = { c.bLogX ? -3.0 : 0.0, 800.0/(c.bLogX ? 5.0 : x.back()), 40.0, c.bLogX };
+        AxisMapping yMap = { 0.0, -600.0/(c.bLogY ? 2.1 : 101.0), 640.0, c.bLogY };
+
+        double best = 1.0e30;
+        for(int r=0; r<nRepeats; r++) {
+            double t0 = now();
+            reference(x, y, xMap, yMap, &expected);
+            best = std::min(best, now()-t0);
+        }
+        printf("%-8s %-8s %10.3f %12.1f %12s\n", c.name, "libm",
+               1.0e9*best/double(nPoints), 1.0e-6*double(nPoints)/best, "-");
+
+        for(int set=ScreenTransform::Scalar; set<=ScreenTransform::bestInstructionSet(); set++) {
+            ScreenTransform::setInstructionSet(ScreenTransform::InstructionSet(set));
+            best = 1.0e30;
+            for(int r=0; r<nRepeats; r++) {
+                double t0 = now();
+                ScreenTransform::mapPoints(x.data(), y.data(), nPoints, xMap, yMap, result.data());
+                best = std::min(best, now()-t0);
+            }
+            printf("%-8s %-8s %10.3f %12.1f %12.2e\n", c.name,
+                   ScreenTransform::name(ScreenTransform::InstructionSet(set)),
+                   1.0e9*best/double(nPoints), 1.0e-6*double(nPoints)/best,
+                   maxDifference(expected, result));
+        }
+    }
+    return 0;
+}
@@ -33,7 +33,7 @@ DEFINES += QT_DEPRECATED_WARNINGS
 DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000
 
 
-CONFIG += c++11
+CONFIG += c++17
 
 SOURCES += main.cpp \
     car.cpp \
@@ -55,8 +55,22 @@ SOURCES += geometryengine.cpp
 SOURCES += \
     roomwidget.cpp
 SOURCES += plot2d.cpp
+SOURCES += plotrenderer.cpp
 SOURCES += plotpropertiesdlg.cpp
 SOURCES += mainwindow.cpp
+SOURCES += serialreader.cpp
+SOURCES += telemetryingest.cpp
+SOURCES += lineframer.cpp
+SOURCES += telemetryparser.cpp
+SOURCES += binarytelemetry.cpp
+SOURCES += renderscheduler.cpp
+SOURCES += commandqueue.cpp
+SOURCES += latencystats.cpp
+SOURCES += screentransform.cpp
+SOURCES += minmaxpyramid.cpp
+SOURCES += multichannelstream.cpp
+SOURCES += plot2dgl.cpp
+SOURCES += plot2dglrenderer.cpp
 
 
 HEADERS += mainwindow.h \
@@ -79,7 +93,22 @@ HEADERS += AxisLimits.h
 HEADERS += DataSetProperties.h
 HEADERS += datastream2d.h
 HEADERS += plot2d.h
+HEADERS += plotrenderer.h
 HEADERS += plotpropertiesdlg.h
+HEADERS += serialreader.h
+HEADERS += telemetryingest.h
+HEADERS += spscring.h
+HEADERS += lineframer.h
+HEADERS += telemetryparser.h
+HEADERS += binarytelemetry.h
+HEADERS += renderscheduler.h
+HEADERS += commandqueue.h
+HEADERS += latencystats.h
+HEADERS += screentransform.h
+HEADERS += minmaxpyramid.h
+HEADERS += multichannelstream.h
+HEADERS += plot2dgl.h
+HEADERS += plot2dglrenderer.h
 
 
 FORMS += controlsdialog.ui
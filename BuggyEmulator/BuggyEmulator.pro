@@ -0,0 +1,23 @@
+# Buggy firmware emulator behind a pseudo terminal (Linux only).
+# Point the GUI serial port to the printed /dev/pts/N (or to the -l link).
+
+TEMPLATE = app
+TARGET   = BuggyEmulator
+CONFIG  += console c++17
+CONFIG  -= qt app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    buggyemulator.cpp \
+    dcmotor.cpp \
+    ../lineframer.cpp \
+    ../binarytelemetry.cpp
+
+HEADERS += \
+    buggyemulator.h \
+    dcmotor.h \
+    ../lineframer.h \
+    ../binarytelemetry.h \
+    ../telemetryparser.h
@@ -0,0 +1,379 @@
+#include "buggyemulator.h"
+#include "../binarytelemetry.h"
+
+#include <charconv>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Same geometry as the Car shown by the GUI
+static const double pulsesPerRevolution = 12*4*9;
+static const double wheelDiameter       = 0.69; // dm
+static const double wheelsDistance      = 2.0;  // dm
+// Ls and Rs (and the M speeds x100) are in units of 5 encoder pulses/s,
+// so that full supply voltage is worth about 255 units
+static const double unitsPerPulseRate   = 0.2;
+
+static const double controlPeriod       = 0.005; // s
+static const double simulationStep      = 1.0e-4;
+static const double watchdogTimeout     = 1.0;
+static const size_t maxPendingOutput    = 65536;
+
+
+BuggyEmulator::BuggyEmulator()
+    : masterFd(-1)
+    , slaveFd(-1)
+    , leftDrive(0.0)
+    , rightDrive(0.0)
+    , t0(now())
+    , simTime(0.0)
+    , nextControl(0.0)
+    , leftSpeedSet(0.0)
+    , rightSpeedSet(0.0)
+    , bBinaryAllowed(true)
+    , bBinary(false)
+    , bSession(false)
+    , bRunning(false)
+    , lastKeepAlive(0.0)
+    , lastAnnounce(-1.0e9)
+    , nFrames(0)
+    , nDropped(0)
+    , nBytes(0)
+{
+    slavePath[0] = '\0';
+    for(int i=0; i<3; i++)
+        gains[0][i] = gains[1][i] = 0.0;
+}
+
+
+BuggyEmulator::~BuggyEmulator() {
+    if(!linkName.empty())
+        unlink(linkName.c_str());
+    if(slaveFd >= 0) close(slaveFd);
+    if(masterFd >= 0) close(masterFd);
+}
+
+
+double
+BuggyEmulator::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return double(ts.tv_sec) + 1.0e-9*double(ts.tv_nsec);
+}
+
+
+bool
+BuggyEmulator::openPty(const char* pLinkName) {
+    masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if(masterFd < 0) {
+        perror("posix_openpt");
+        return false;
+    }
+    if(grantpt(masterFd) || unlockpt(masterFd) ||
+       ptsname_r(masterFd, slavePath, sizeof(slavePath)))
+    {
+        perror("Unable to setup the pty");
+        return false;
+    }
+    fcntl(masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+    // Keep our own slave descriptor open: the master will never see a
+    // hang up when the GUI closes the port and the line stays raw
+    // (no echo of our own records) before the GUI opens it.
+    slaveFd = open(slavePath, O_RDWR | O_NOCTTY);
+    if(slaveFd < 0) {
+        perror(slavePath);
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(slaveFd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slaveFd, TCSANOW, &tio);
+    if(pLinkName) {
+        unlink(pLinkName);
+        if(symlink(slavePath, pLinkName)) {
+            perror(pLinkName);
+            return false;
+        }
+        linkName = pLinkName;
+    }
+    return true;
+}
+
+
+const char*
+BuggyEmulator::slaveName() const {
+    return linkName.empty() ? slavePath : linkName.c_str();
+}
+
+
+void
+BuggyEmulator::setBinaryAllowed(bool bAllowed) {
+    bBinaryAllowed = bAllowed;
+}
+
+
+double
+BuggyEmulator::toUnits(double w) const {
+    return w/(2.0*M_PI) * pulsesPerRevolution * unitsPerPulseRate;
+}
+
+
+double
+BuggyEmulator::fromUnits(double units) const {
+    return units/(unitsPerPulseRate*pulsesPerRevolution) * 2.0*M_PI;
+}
+
+
+void
+BuggyEmulator::run(double rate, volatile sig_atomic_t* pbStop) {
+    double period = 1.0/rate;
+    double next   = now();
+    double lastReport = next;
+    unsigned long long lastFrames = 0;
+    unsigned long long lastBytes  = 0;
+    while(!*pbStop) {
+        double t = now();
+        readCommands(t);
+        if(bSession && (t-lastKeepAlive > watchdogTimeout))
+            endSession();
+        // Once in binary the text announces would corrupt the records
+        if(!bSession && !bBinary && (t-lastAnnounce >= 1.0)) {
+            send("Buggy Ready\n", 12);
+            lastAnnounce = t;
+        }
+        simulate(t-t0);
+        if(bSession)
+            sendFrame(t);
+        flushOutput();
+
+        if(t-lastReport >= 1.0) {
+            fprintf(stderr, "%s: %.0f frames/s  %.0f B/s  dropped:%llu\n",
+                    bSession ? (bBinary ? "binary" : "text") : "waiting",
+                    double(nFrames-lastFrames)/(t-lastReport),
+                    double(nBytes-lastBytes)/(t-lastReport),
+                    nDropped);
+            lastFrames = nFrames;
+            lastBytes  = nBytes;
+            lastReport = t;
+        }
+
+        next += period;
+        if(next < t-0.1)
+            next = t; // Too late: do not try to catch up
+        struct timespec deadline;
+        deadline.tv_sec  = time_t(next);
+        deadline.tv_nsec = long((next-double(deadline.tv_sec))*1.0e9);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+    }
+}
+
+
+void
+BuggyEmulator::simulate(double t) {
+    while(simTime < t) {
+        if(simTime >= nextControl) {
+            if(bRunning) {
+                leftDrive  = leftMotor.control(controlPeriod);
+                rightDrive = rightMotor.control(controlPeriod);
+            }
+            else {
+                leftDrive  = 0.0;
+                rightDrive = 0.0;
+            }
+            nextControl += controlPeriod;
+        }
+        leftMotor.step(simulationStep, leftDrive);
+        rightMotor.step(simulationStep, rightDrive);
+        simTime += simulationStep;
+    }
+}
+
+
+void
+BuggyEmulator::readCommands(double t) {
+    for(;;) {
+        size_t nFree;
+        char* pFree = commandFramer.writeBuffer(&nFree);
+        ssize_t nRead = read(masterFd, pFree, nFree);
+        if(nRead <= 0)
+            break;
+        commandFramer.commit(size_t(nRead));
+    }
+    std::string_view command;
+    while(commandFramer.nextLine(&command))
+        execute(command, t);
+}
+
+
+void
+BuggyEmulator::execute(std::string_view command, double t) {
+    while(!command.empty() && (command.back() == '\r'))
+        command.remove_suffix(1);
+    if(command.empty())
+        return;
+    if(command == "K") {
+        lastKeepAlive = t;
+        if(!bSession)
+            startSession();
+    }
+    else if(command == "G") {
+        bRunning = true;
+        leftMotor.setTarget(fromUnits(leftSpeedSet));
+        rightMotor.setTarget(fromUnits(rightSpeedSet));
+    }
+    else if(command == "H") {
+        bRunning = false;
+        leftMotor.halt();
+        rightMotor.halt();
+    }
+    else if(command == "P") {
+        sendParamsRequest();
+    }
+    else if(command == "B") {
+        if(bBinaryAllowed && !bBinary) {
+            send("Buggy Binary\n", 13);
+            bBinary = true;
+        }
+    }
+    else if(command.size() > 2) {
+        int value = 0;
+        std::from_chars(command.data()+2, command.data()+command.size(), value);
+        std::string_view key = command.substr(0, 2);
+        int iMotor = (key[0] == 'L') ? 0 : 1;
+        DcMotor* pMotor = iMotor ? &rightMotor : &leftMotor;
+        if((key[0] != 'L') && (key[0] != 'R'))
+            return;
+        // The PID gains are received x100
+        double* pGains = gains[iMotor];
+        switch(key[1]) {
+        case 'p': pGains[0] = value/100.0; break;
+        case 'i': pGains[1] = value/100.0; break;
+        case 'd': pGains[2] = value/100.0; break;
+        case 's':
+            if(iMotor) rightSpeedSet = value;
+            else       leftSpeedSet  = value;
+            if(bRunning)
+                pMotor->setTarget(fromUnits(value));
+            return;
+        default:
+            return;
+        }
+        // The controller works on rad/s: scale the gains given in speed units
+        double scale = toUnits(1.0);
+        pMotor->setGains(pGains[0]*scale, pGains[1]*scale, pGains[2]*scale);
+    }
+}
+
+
+void
+BuggyEmulator::startSession() {
+    bSession = true;
+    sendParamsRequest();
+}
+
+
+// In binary a record carrying only the ParamsRequest field
+void
+BuggyEmulator::sendParamsRequest() {
+    if(bBinary) {
+        TelemetryFrame frame = {};
+        frame.fields = TelemetryFrame::ParamsRequest;
+        unsigned char buffer[BinaryTelemetry::maxEncodedSize];
+        send(reinterpret_cast<const char*>(buffer),
+             BinaryTelemetry::encode(frame, buffer));
+    }
+    else {
+        send("P\n", 2);
+    }
+}
+
+
+// The watchdog resets the firmware, which restarts in text mode and
+// announces itself again: the host recognizes the "Buggy Ready" also
+// while in binary mode and negotiates the framing again (see
+// TelemetryIngest::commit()).
+void
+BuggyEmulator::endSession() {
+    if(bBinary)
+        fprintf(stderr, "Watchdog: back to the text framing\n");
+    bSession = false;
+    bBinary  = false;
+    bRunning = false;
+    leftMotor.halt();
+    rightMotor.halt();
+    output.clear();
+}
+
+
+void
+BuggyEmulator::sendFrame(double t) {
+    if(output.size() > maxPendingOutput) {
+        nDropped++; // The GUI is not reading
+        return;
+    }
+    double leftPath  = leftMotor.angle() /(2.0*M_PI) * pulsesPerRevolution;
+    double rightPath = rightMotor.angle()/(2.0*M_PI) * pulsesPerRevolution;
+    double yaw = ((rightMotor.angle()-leftMotor.angle()) * 0.5*wheelDiameter) / wheelsDistance;
+
+    TelemetryFrame frame;
+    frame.fields = TelemetryFrame::Attitude | TelemetryFrame::Motors | TelemetryFrame::Time;
+    frame.q0 = float(cos(0.5*yaw));
+    frame.q1 = 0.0f;
+    frame.q2 = 0.0f;
+    frame.q3 = float(sin(0.5*yaw));
+    frame.leftSpeed  = round(toUnits(leftMotor.speed())) /100.0;
+    frame.leftPath   = round(leftPath);
+    frame.rightSpeed = round(toUnits(rightMotor.speed()))/100.0;
+    frame.rightPath  = round(rightPath);
+    frame.dTime      = floor((t-t0)*1000.0);
+    if((nFrames % 10) == 0) {
+        frame.fields |= TelemetryFrame::Obstacle;
+        frame.obstacleDistance = round(100.0 + 50.0*sin(0.2*(t-t0)));
+    }
+
+    if(bBinary) {
+        unsigned char buffer[BinaryTelemetry::maxEncodedSize];
+        send(reinterpret_cast<const char*>(buffer),
+             BinaryTelemetry::encode(frame, buffer));
+    }
+    else {
+        char buffer[160];
+        int size = snprintf(buffer, sizeof(buffer),
+                            "A,%ld,%ld,%ld,%ld,M,%ld,%ld,%ld,%ld,",
+                            lround(frame.q0*1000.0), lround(frame.q1*1000.0),
+                            lround(frame.q2*1000.0), lround(frame.q3*1000.0),
+                            lround(frame.leftSpeed*100.0), lround(frame.leftPath),
+                            lround(frame.rightSpeed*100.0), lround(frame.rightPath));
+        if(frame.fields & TelemetryFrame::Obstacle)
+            size += snprintf(buffer+size, sizeof(buffer)-size_t(size),
+                             "D,%ld,", lround(frame.obstacleDistance));
+        size += snprintf(buffer+size, sizeof(buffer)-size_t(size),
+                         "T,%lld\n", llround(frame.dTime));
+        send(buffer, size_t(size));
+    }
+    nFrames++;
+}
+
+
+void
+BuggyEmulator::send(const char* pData, size_t size) {
+    output.append(pData, size);
+}
+
+
+void
+BuggyEmulator::flushOutput() {
+    if(output.empty())
+        return;
+    ssize_t nWritten = write(masterFd, output.data(), output.size());
+    if(nWritten > 0) {
+        output.erase(0, size_t(nWritten));
+        nBytes += (unsigned long long)nWritten;
+    }
+}
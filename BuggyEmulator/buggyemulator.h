@@ -0,0 +1,69 @@
+#pragma once
+
+#include "dcmotor.h"
+#include "../lineframer.h"
+
+#include <signal.h>
+#include <string>
+#include <string_view>
+
+
+// Emulates the Buggy firmware behind a Linux pseudo terminal.
+//
+// Until the first Keep Alive it announces "Buggy Ready" once a second
+// (but after the "B" handshake, as then it talks binary only).
+// Then it asks the PID parameters ("P") and streams A/M/(D)/T records,
+// in text or (after the "B" handshake) in binary, at the chosen rate.
+// Without a "K" for more than a second it halts and starts announcing
+// again, as the firmware watchdog does.
+class BuggyEmulator
+{
+public:
+    BuggyEmulator();
+    ~BuggyEmulator();
+    bool        openPty(const char* pLinkName);
+    const char* slaveName() const;
+    void        setBinaryAllowed(bool bAllowed);
+    void        run(double rate, volatile sig_atomic_t* pbStop);
+
+protected:
+    static double now();
+    void   simulate(double t);
+    void   readCommands(double t);
+    void   execute(std::string_view command, double t);
+    void   startSession();
+    void   endSession();
+    void   sendParamsRequest();
+    void   sendFrame(double t);
+    void   send(const char* pData, size_t size);
+    void   flushOutput();
+    double toUnits(double w) const;
+    double fromUnits(double units) const;
+
+private:
+    int         masterFd;
+    int         slaveFd;
+    char        slavePath[128];
+    std::string linkName;
+    LineFramer  commandFramer;
+    DcMotor     leftMotor;
+    DcMotor     rightMotor;
+    double      leftDrive;
+    double      rightDrive;
+    double      t0;
+    double      simTime;
+    double      nextControl;
+    double      leftSpeedSet;  // In the units of Ls and Rs
+    double      rightSpeedSet;
+    double      gains[2][3];   // Kp, Ki, Kd of the left and right motors
+    bool        bBinaryAllowed;
+    bool        bBinary;
+    bool        bSession;
+    bool        bRunning;
+    double      lastKeepAlive;
+    double      lastAnnounce;
+    unsigned long long nFrames;
+    unsigned long long nDropped;
+    unsigned long long nBytes;
+    std::string output;
+};
@@ -0,0 +1,102 @@
+#include "dcmotor.h"
+
+
+DcMotor::DcMotor()
+    : w(0.0)
+    , i(0.0)
+    , theta(0.0)
+    , kp(0.0)
+    , ki(0.0)
+    , kd(0.0)
+    , target(0.0)
+    , integral(0.0)
+    , lastError(0.0)
+    , drive(0.0)
+{
+    // A small 6V gearmotor: about 3 rev/s at full drive, with a
+    // mechanical time constant of about 10 ms.
+    Parameters defaults;
+    defaults.J    = 5.0e-4;
+    defaults.b    = 2.75e-3;
+    defaults.K    = 0.3;
+    defaults.R    = 2.0;
+    defaults.L    = 5.0e-3;
+    defaults.vMax = 6.0;
+    setParameters(defaults);
+}
+
+
+void
+DcMotor::setParameters(const Parameters& newParameters) {
+    p = newParameters;
+}
+
+
+void
+DcMotor::setGains(double newKp, double newKi, double newKd) {
+    kp = newKp;
+    ki = newKi;
+    kd = newKd;
+}
+
+
+void
+DcMotor::setTarget(double newTarget) {
+    target = newTarget;
+}
+
+
+void
+DcMotor::halt() {
+    target    = 0.0;
+    integral  = 0.0;
+    lastError = 0.0;
+    drive     = 0.0;
+}
+
+
+void
+DcMotor::step(double dt, double newDrive) {
+    // Semi-implicit Euler: dt must be well below L/R
+    double v = p.vMax * newDrive/255.0;
+    i += dt * (v - p.R*i - p.K*w) / p.L;
+    w += dt * (p.K*i - p.b*w) / p.J;
+    theta += dt * w;
+}
+
+
+double
+DcMotor::control(double dt) {
+    double error = target - w;
+    integral += error * dt;
+    double derivative = (error - lastError) / dt;
+    lastError = error;
+    drive = kp*error + ki*integral + kd*derivative;
+    if(drive > 255.0) {
+        drive = 255.0;
+        integral -= error * dt; // Anti windup
+    }
+    else if(drive < -255.0) {
+        drive = -255.0;
+        integral -= error * dt;
+    }
+    return drive;
+}
+
+
+double
+DcMotor::speed() const {
+    return w;
+}
+
+
+double
+DcMotor::angle() const {
+    return theta;
+}
+
+
+double
+DcMotor::lastDrive() const {
+    return drive;
+}
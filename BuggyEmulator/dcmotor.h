@@ -0,0 +1,46 @@
+#pragma once
+
+
+// Armature controlled DC motor (see BuggyDocs/0_DcMotorModel.pdf):
+//
+//   J dw/dt = K i - b w
+//   L di/dt = V - R i - K w
+//
+// driven by a discrete PID speed controller, as the one running
+// on the Buggy firmware.
+class DcMotor
+{
+public:
+    struct Parameters {
+        double J;    // Rotor (+ wheel) inertia      [kg m^2]
+        double b;    // Viscous friction             [N m s]
+        double K;    // Torque and back emf constant [N m/A] = [V s]
+        double R;    // Armature resistance          [Ohm]
+        double L;    // Armature inductance          [H]
+        double vMax; // Supply voltage               [V]
+    };
+
+    DcMotor();
+    void   setParameters(const Parameters& newParameters);
+    void   setGains(double newKp, double newKi, double newKd);
+    void   setTarget(double newTarget);
+    void   halt();
+    // Advance the motor by dt seconds at the given drive (-255..255)
+    void   step(double dt, double drive);
+    // Run the PID controller over one control period and return the drive
+    double control(double dt);
+    double speed() const;     // [rad/s]
+    double angle() const;     // [rad]
+    double lastDrive() const;
+
+private:
+    Parameters p;
+    double w;                 // Angular speed
+    double i;                 // Armature current
+    double theta;             // Shaft angle
+    double kp, ki, kd;
+    double target;            // [rad/s]
+    double integral;
+    double lastError;
+    double drive;
+};
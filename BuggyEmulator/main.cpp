@@ -0,0 +1,61 @@
+#include "buggyemulator.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static volatile sig_atomic_t bStop = 0;
+
+
+static void
+onSignal(int) {
+    bStop = 1;
+}
+
+
+static void
+usage(const char* pName) {
+    fprintf(stderr,
+            "Usage: %s [-r rate] [-l link] [-t]\n"
+            "  -r rate  telemetry records per second (default 100)\n"
+            "  -l link  symbolic link to the pty slave (e.g. /tmp/ttyBuggy)\n"
+            "  -t       text only: refuse the binary framing\n",
+            pName);
+}
+
+
+int
+main(int argc, char* argv[]) {
+    double rate = 100.0;
+    const char* pLinkName = nullptr;
+    bool bBinaryAllowed = true;
+    for(int i=1; i<argc; i++) {
+        if(!strcmp(argv[i], "-r") && (i+1 < argc))
+            rate = atof(argv[++i]);
+        else if(!strcmp(argv[i], "-l") && (i+1 < argc))
+            pLinkName = argv[++i];
+        else if(!strcmp(argv[i], "-t"))
+            bBinaryAllowed = false;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if((rate <= 0.0) || (rate > 20000.0)) {
+        fprintf(stderr, "Rate must be in (0, 20000]\n");
+        return 1;
+    }
+
+    signal(SIGINT,  onSignal);
+    signal(SIGTERM, onSignal);
+
+    BuggyEmulator emulator;
+    emulator.setBinaryAllowed(bBinaryAllowed);
+    if(!emulator.openPty(pLinkName))
+        return 1;
+    fprintf(stderr, "Buggy emulator on %s at %.0f Hz\n", emulator.slaveName(), rate);
+    emulator.run(rate, &bStop);
+    return 0;
+}
@@ -0,0 +1,34 @@
+# Batch export of the recorded sessions to PNG or SVG, one picture per
+# motor plot. Runs without a display:
+#   QT_QPA_PLATFORM=offscreen ./PlotExport -o pictures Session_*.csv
+
+TEMPLATE = app
+TARGET   = PlotExport
+QT      += core gui svg
+CONFIG  += console c++17
+CONFIG  -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    ../plotexporter.cpp \
+    ../plotrenderer.cpp \
+    ../datastream2d.cpp \
+    ../DataSetProperties.cpp \
+    ../AxisLimits.cpp \
+    ../AxisFrame.cpp \
+    ../screentransform.cpp \
+    ../minmaxpyramid.cpp \
+    ../multichannelstream.cpp
+
+HEADERS += \
+    ../plotexporter.h \
+    ../plotrenderer.h \
+    ../datastream2d.h \
+    ../DataSetProperties.h \
+    ../AxisLimits.h \
+    ../AxisFrame.h \
+    ../screentransform.h \
+    ../minmaxpyramid.h \
+    ../multichannelstream.h
@@ -0,0 +1,79 @@
+#include "plotexporter.h"
+
+#include <QGuiApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+#include <stdio.h>
+
+
+static void
+usage(const char* pName) {
+    fprintf(stderr,
+            "Usage: %s [-f png|svg] [-s WxH] [-o dir] [-j threads] session.csv...\n"
+            "  -f format   picture format (default png)\n"
+            "  -s WxH      picture size in pixels (default 1280x720)\n"
+            "  -o dir      output directory (default .)\n"
+            "  -j threads  sessions rendered at the same time (default: all cores)\n"
+            "Without a display run it with QT_QPA_PLATFORM=offscreen\n",
+            pName);
+}
+
+
+int
+main(int argc, char* argv[]) {
+    QGuiApplication application(argc, argv);
+    QStringList args = application.arguments();
+    PlotExporter exporter;
+    QStringList sessionFiles;
+    for(int i=1; i<args.count(); i++) {
+        QString sArg = args.at(i);
+        bool bHasValue = i+1 < args.count();
+        if((sArg == "-f") && bHasValue) {
+            QString sFormat = args.at(++i).toLower();
+            if(sFormat == "svg")
+                exporter.setFormat(PlotExporter::Svg);
+            else if(sFormat == "png")
+                exporter.setFormat(PlotExporter::Png);
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if((sArg == "-s") && bHasValue) {
+            QStringList sizes = args.at(++i).split('x');
+            int w = sizes.value(0).toInt();
+            int h = sizes.count() == 2 ? sizes.at(1).toInt() : 0;
+            if((w < 100) || (h < 100)) {
+                fprintf(stderr, "Size must be at least 100x100\n");
+                return 1;
+            }
+            exporter.setSize(QSize(w, h));
+        }
+        else if((sArg == "-o") && bHasValue) {
+            exporter.setOutputDir(args.at(++i));
+        }
+        else if((sArg == "-j") && bHasValue) {
+            QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, args.at(++i).toInt()));
+        }
+        else if(sArg.startsWith('-')) {
+            usage(argv[0]);
+            return 1;
+        }
+        else {
+            sessionFiles.append(sArg);
+        }
+    }
+    if(sessionFiles.isEmpty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int nWritten = exporter.exportSessions(sessionFiles);
+    fprintf(stderr, "%d pictures from %d sessions in %.2f s\n",
+            nWritten, int(sessionFiles.count()), 1.0e-3*double(timer.elapsed()));
+    return (nWritten == 2*sessionFiles.count()) ? 0 : 1;
+}
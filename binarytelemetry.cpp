@@ -0,0 +1,169 @@
+#include "binarytelemetry.h"
+
+#include <math.h>
+
+
+namespace {
+
+
+struct Crc16Table {
+    uint16_t value[256];
+
+    Crc16Table() {
+        for(int i=0; i<256; i++) {
+            uint16_t crc = uint16_t(i << 8);
+            for(int bit=0; bit<8; bit++)
+                crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021) : uint16_t(crc << 1);
+            value[i] = crc;
+        }
+    }
+};
+
+
+const Crc16Table crc16Table;
+
+
+inline int16_t
+readInt16(const unsigned char* p) {
+    return int16_t(uint16_t(p[0] | (p[1] << 8)));
+}
+
+
+inline uint16_t
+readUInt16(const unsigned char* p) {
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+
+inline uint32_t
+readUInt32(const unsigned char* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+           (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+
+inline void
+writeUInt16(unsigned char* p, uint16_t value) {
+    p[0] = uint8_t(value);
+    p[1] = uint8_t(value >> 8);
+}
+
+
+inline void
+writeUInt32(unsigned char* p, uint32_t value) {
+    p[0] = uint8_t(value);
+    p[1] = uint8_t(value >> 8);
+    p[2] = uint8_t(value >> 16);
+    p[3] = uint8_t(value >> 24);
+}
+
+
+} // namespace
+
+
+uint16_t
+BinaryTelemetry::crc16(const unsigned char* pData, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for(size_t i=0; i<size; i++)
+        crc = uint16_t((crc << 8) ^ crc16Table.value[((crc >> 8) ^ pData[i]) & 0xFF]);
+    return crc;
+}
+
+
+size_t
+BinaryTelemetry::cobsEncode(const unsigned char* pIn, size_t size, unsigned char* pOut) {
+    size_t iCode = 0;
+    size_t iOut  = 1;
+    unsigned char code = 1;
+    for(size_t i=0; i<size; i++) {
+        if(pIn[i] == 0) {
+            pOut[iCode] = code;
+            iCode = iOut++;
+            code = 1;
+        }
+        else {
+            pOut[iOut++] = pIn[i];
+            if(++code == 0xFF) {
+                pOut[iCode] = code;
+                iCode = iOut++;
+                code = 1;
+            }
+        }
+    }
+    pOut[iCode] = code;
+    return iOut;
+}
+
+
+// Returns the decoded size or 0 on malformed input
+size_t
+BinaryTelemetry::cobsDecode(const unsigned char* pIn, size_t size,
+                            unsigned char* pOut, size_t outSize)
+{
+    size_t iIn  = 0;
+    size_t iOut = 0;
+    while(iIn < size) {
+        unsigned char code = pIn[iIn++];
+        if(code == 0)
+            return 0;
+        for(unsigned char j=1; j<code; j++) {
+            if((iIn == size) || (iOut == outSize) || (pIn[iIn] == 0))
+                return 0;
+            pOut[iOut++] = pIn[iIn++];
+        }
+        if((code != 0xFF) && (iIn < size)) {
+            if(iOut == outSize)
+                return 0;
+            pOut[iOut++] = 0;
+        }
+    }
+    return iOut;
+}
+
+
+bool
+BinaryTelemetry::decode(std::string_view packet, TelemetryFrame* pFrame) {
+    unsigned char record[recordSize];
+    if(packet.size() > maxEncodedSize)
+        return false;
+    size_t size = cobsDecode(reinterpret_cast<const unsigned char*>(packet.data()),
+                             packet.size(), record, recordSize);
+    if(size != recordSize)
+        return false;
+    if(crc16(record, payloadSize) != readUInt16(record+payloadSize))
+        return false;
+
+    pFrame->fields           = record[0];
+    pFrame->q0               = float(readInt16(record+1)/1000.0);
+    pFrame->q1               = float(readInt16(record+3)/1000.0);
+    pFrame->q2               = float(readInt16(record+5)/1000.0);
+    pFrame->q3               = float(readInt16(record+7)/1000.0);
+    pFrame->leftSpeed        = readInt16(record+9)/100.0;
+    pFrame->leftPath         = int32_t(readUInt32(record+11));
+    pFrame->rightSpeed       = readInt16(record+15)/100.0;
+    pFrame->rightPath        = int32_t(readUInt32(record+17));
+    pFrame->obstacleDistance = readUInt16(record+21);
+    pFrame->dTime            = readUInt32(record+23);
+    return pFrame->fields != 0;
+}
+
+
+size_t
+BinaryTelemetry::encode(const TelemetryFrame& frame, unsigned char* pOut) {
+    unsigned char record[recordSize];
+    record[0] = uint8_t(frame.fields);
+    writeUInt16(record+1,  uint16_t(int16_t(lround(frame.q0*1000.0))));
+    writeUInt16(record+3,  uint16_t(int16_t(lround(frame.q1*1000.0))));
+    writeUInt16(record+5,  uint16_t(int16_t(lround(frame.q2*1000.0))));
+    writeUInt16(record+7,  uint16_t(int16_t(lround(frame.q3*1000.0))));
+    writeUInt16(record+9,  uint16_t(int16_t(lround(frame.leftSpeed*100.0))));
+    writeUInt32(record+11, uint32_t(int32_t(lround(frame.leftPath))));
+    writeUInt16(record+15, uint16_t(int16_t(lround(frame.rightSpeed*100.0))));
+    writeUInt32(record+17, uint32_t(int32_t(lround(frame.rightPath))));
+    writeUInt16(record+21, uint16_t(lround(frame.obstacleDistance)));
+    writeUInt32(record+23, uint32_t(llround(frame.dTime)));
+    writeUInt16(record+payloadSize, crc16(record, payloadSize));
+    size_t size = cobsEncode(record, recordSize, pOut);
+    pOut[size++] = 0; // Delimiter
+    return size;
+}
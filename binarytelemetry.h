@@ -0,0 +1,47 @@
+#pragma once
+
+#include "telemetryparser.h"
+
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+
+// Optional binary telemetry framing, negotiated at "Buggy Ready":
+//
+//   Buggy -> "Buggy Ready\n"
+//   Host  -> "B\n"              (binary framing requested)
+//   Buggy -> "Buggy Binary\n"   (acknowledge, binary records follow)
+//
+// Each record is COBS encoded and terminated by a 0x00 byte.
+// Decoded, it has a fixed little endian layout:
+//
+//   offset size
+//      0     1   fields (TelemetryFrame::Field mask)
+//      1     8   q0, q1, q2, q3      int16 (x1000)
+//      9     2   leftSpeed           int16 (x100)
+//     11     4   leftPath            int32
+//     15     2   rightSpeed          int16 (x100)
+//     17     4   rightPath           int32
+//     21     2   obstacleDistance    uint16
+//     23     4   time (ms)           uint32
+//     27     2   CRC16-CCITT (poly 0x1021, init 0xFFFF) of bytes 0..26
+//
+// Commands sent to the Buggy remain plain text.
+class BinaryTelemetry
+{
+public:
+    static const size_t payloadSize = 27;
+    static const size_t recordSize  = payloadSize + 2;
+    // Worst case COBS size of a record, delimiter included
+    static const size_t maxEncodedSize = recordSize + recordSize/254 + 2;
+
+    static uint16_t crc16(const unsigned char* pData, size_t size);
+    static size_t   cobsEncode(const unsigned char* pIn, size_t size, unsigned char* pOut);
+    static size_t   cobsDecode(const unsigned char* pIn, size_t size,
+                               unsigned char* pOut, size_t outSize);
+    // Decode a packet (delimiter excluded): corrupted packets are rejected
+    static bool     decode(std::string_view packet, TelemetryFrame* pFrame);
+    // Encode a record (delimiter included), returns the bytes written
+    static size_t   encode(const TelemetryFrame& frame, unsigned char* pOut);
+};
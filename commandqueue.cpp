@@ -0,0 +1,59 @@
+#include "commandqueue.h"
+
+#include <charconv>
+
+
+// Must follow the order of CommandQueue::Key
+static const char* keyNames[CommandQueue::nKeys] = {
+    "Lp", "Li", "Ld", "Ls",
+    "Rp", "Ri", "Rd", "Rs"
+};
+
+
+CommandQueue::CommandQueue(int flushInterval, QObject *parent)
+    : QObject(parent)
+    , pendingMask(0)
+{
+    for(int i=0; i<nKeys; i++)
+        values[i] = 0;
+    connect(&flushTimer, SIGNAL(timeout()),
+            this, SLOT(flush()));
+    flushTimer.start(flushInterval);
+}
+
+
+void
+CommandQueue::setValue(Key key, int value) {
+    values[key] = value;
+    pendingMask |= (1u << key);
+}
+
+
+void
+CommandQueue::discard(Key key) {
+    pendingMask &= ~(1u << key);
+}
+
+
+void
+CommandQueue::sendNow(const char* pCommand) {
+    emit writeToBuggy(QByteArray(pCommand));
+}
+
+
+void
+CommandQueue::flush() {
+    if(!pendingMask) return;
+    char buffer[nKeys*16]; // Key, up to 11 chars for the value and '\n'
+    char* p = buffer;
+    for(int i=0; i<nKeys; i++) {
+        if(!(pendingMask & (1u << i)))
+            continue;
+        *p++ = keyNames[i][0];
+        *p++ = keyNames[i][1];
+        p = std::to_chars(p, buffer+sizeof(buffer), values[i]).ptr;
+        *p++ = '\n';
+    }
+    pendingMask = 0;
+    emit writeToBuggy(QByteArray(buffer, int(p-buffer)));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QByteArray>
+
+
+// Coalesces the parameter updates sent to the Buggy: only the latest
+// value of each key is kept and all the pending values leave together,
+// in a single write, at a fixed cadence.
+// Urgent commands (Keep Alive, Go, Halt) bypass the queue.
+class CommandQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Key {
+        LeftP, LeftI, LeftD, LeftSpeed,
+        RightP, RightI, RightD, RightSpeed,
+        nKeys
+    };
+
+    explicit CommandQueue(int flushInterval = 50, QObject *parent = nullptr);
+    void setValue(Key key, int value);
+    void discard(Key key);
+    void sendNow(const char* pCommand);
+
+public slots:
+    void flush();
+
+signals:
+    void writeToBuggy(QByteArray data);
+
+private:
+    QTimer   flushTimer;
+    int      values[nKeys];
+    unsigned pendingMask;
+};
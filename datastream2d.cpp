@@ -17,10 +17,99 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *
 */
 #include "datastream2d.h"
+#include "multichannelstream.h"
 #include <float.h>
+#include <math.h>
+#include <QtNumeric>
+
+
+RunningExtremum::RunningExtremum(bool bMaximum)
+    : first(0)
+    , n(0)
+    , bMax(bMaximum)
+{
+}
+
+
+void
+RunningExtremum::reset(int windowSize) {
+    sequences.resize(windowSize);
+    values.resize(windowSize);
+    first = 0;
+    n = 0;
+}
+
+
+void
+RunningExtremum::push(quint64 sequence, double value) {
+    int capacity = sequences.count();
+    // Drop from the back every value the new one supersedes
+    while(n > 0) {
+        int last = first+n-1;
+        if(last >= capacity) last -= capacity;
+        if(bMax ? (values.at(last) > value) : (values.at(last) < value))
+            break;
+        n--;
+    }
+    int pos = first+n;
+    if(pos >= capacity) pos -= capacity;
+    sequences[pos] = sequence;
+    values[pos] = value;
+    n++;
+}
+
+
+void
+RunningExtremum::evict(quint64 sequence) {
+    if((n > 0) && (sequences.at(first) == sequence)) {
+        if(++first == sequences.count()) first = 0;
+        n--;
+    }
+}
+
+
+void
+RunningExtremum::evictBefore(quint64 sequence) {
+    while((n > 0) && (sequences.at(first) < sequence)) {
+        if(++first == sequences.count()) first = 0;
+        n--;
+    }
+}
+
+
+double
+RunningExtremum::value() const {
+    return values.at(first);
+}
+
+
+bool
+RunningExtremum::isEmpty() const {
+    return n == 0;
+}
+
 
 DataStream2D::DataStream2D(int Id, int PenWidth, QColor Color, int Symbol, QString Title)
+    : maxPoints(0)
+    , first(0)
+    , nPoints(0)
+    , nAdded(0)
+    , xMin(false)
+    , xMax(true)
+    , yMin(false)
+    , yMax(true)
+    , bLogXCache(false)
+    , bLogYCache(false)
+    , logXMin(false)
+    , logXMax(true)
+    , logYMin(false)
+    , logYMax(true)
+    , pHistory(nullptr)
+    , pSource(nullptr)
+    , iChannel(0)
 {
+    minLogX = maxLogX = qQNaN();
+    minLogY = maxLogY = qQNaN();
     Properties.SetId(Id);
     Properties.Color    = Color;
     Properties.PenWidth = PenWidth;
@@ -31,21 +120,101 @@ DataStream2D::DataStream2D(int Id, int PenWidth, QColor Color, int Symbol, QStri
         Properties.Title = QString("Data Set %1").arg(Properties.GetId());
     isShown         = false;
     bShowCurveTitle = false;
-    maxPoints = 100;
+    setMaxPoints(100);
 }
 
 
-DataStream2D::DataStream2D(DataSetProperties myProperties) {
+DataStream2D::DataStream2D(DataSetProperties myProperties)
+    : maxPoints(0)
+    , first(0)
+    , nPoints(0)
+    , nAdded(0)
+    , xMin(false)
+    , xMax(true)
+    , yMin(false)
+    , yMax(true)
+    , bLogXCache(false)
+    , bLogYCache(false)
+    , logXMin(false)
+    , logXMax(true)
+    , logYMin(false)
+    , logYMax(true)
+    , pHistory(nullptr)
+    , pSource(nullptr)
+    , iChannel(0)
+{
+    minLogX = maxLogX = qQNaN();
+    minLogY = maxLogY = qQNaN();
     Properties = myProperties;
     if(myProperties.Title == QString())
         Properties.Title = QString("Data Set %1").arg(Properties.GetId());
     isShown         = false;
     bShowCurveTitle = false;
-    maxPoints = 100;
+    setMaxPoints(100);
 }
 
 
 DataStream2D::~DataStream2D() {
+    delete pHistory;
+}
+
+
+// The history keeps every sample added, also the ones already gone
+// from the ring buffer, at a resolution halving level by level.
+void
+DataStream2D::setHistory(bool bEnable) {
+    if(pSource) {
+        pSource->setHistory(iChannel, bEnable);
+        return;
+    }
+    if(bEnable && !pHistory) {
+        pHistory = new MinMaxPyramid();
+    }
+    else if(!bEnable) {
+        delete pHistory;
+        pHistory = nullptr;
+    }
+}
+
+
+// Null when the history is disabled
+const MinMaxPyramid*
+DataStream2D::history() const {
+    return pSource ? pSource->history(iChannel) : pHistory;
+}
+
+
+// The own buffers are released while the samples come from a source
+void
+DataStream2D::setSource(MultiChannelStream* pStream, int channel) {
+    int nMax = getMaxPoints();
+    pSource  = pStream;
+    iChannel = channel;
+    first    = 0;
+    nPoints  = 0;
+    nAdded   = 0;
+    maxPoints = 0;
+    xData = QVector<double>();
+    yData = QVector<double>();
+    xMin.reset(0);
+    xMax.reset(0);
+    yMin.reset(0);
+    yMax.reset(0);
+    bLogXCache = false;
+    bLogYCache = false;
+    rebuildLogCache();
+    delete pHistory;
+    pHistory = nullptr;
+    if(!pSource)
+        setMaxPoints(nMax);
+    else if(pSource->count() > 0)
+        updateBounds();
+}
+
+
+MultiChannelStream*
+DataStream2D::source() const {
+    return pSource;
 }
 
 
@@ -55,35 +224,210 @@ DataStream2D::SetShow(bool show) {
 }
 
 
+int
+DataStream2D::slot(int i) const {
+    int pos = first+i;
+    return pos < maxPoints ? pos : pos-maxPoints;
+}
+
+
+int
+DataStream2D::count() const {
+    return pSource ? pSource->count() : nPoints;
+}
+
+
+double
+DataStream2D::x(int i) const {
+    return pSource ? pSource->x(i) : xData.at(slot(i));
+}
+
+
+double
+DataStream2D::y(int i) const {
+    return pSource ? pSource->y(iChannel, i) : yData.at(slot(i));
+}
+
+
+bool
+DataStream2D::floatValues() const {
+    return pSource && pSource->isFloat();
+}
+
+
+int
+DataStream2D::contiguous(int i, const double** ppX, const double** ppY) const {
+    if(pSource)
+        return pSource->contiguous(i, iChannel, ppX, ppY);
+    int pos = slot(i);
+    *ppX = xData.constData()+pos;
+    *ppY = yData.constData()+pos;
+    return qMin(nPoints-i, maxPoints-pos);
+}
+
+
+int
+DataStream2D::contiguous(int i, const double** ppX, const float** ppY) const {
+    if(pSource)
+        return pSource->contiguous(i, iChannel, ppX, ppY);
+    *ppX = nullptr;
+    *ppY = nullptr;
+    return 0;
+}
+
+
+int
+DataStream2D::contiguousLog(int i, const double** ppX, const double** ppY) const {
+    int pos = slot(i);
+    *ppX = (bLogXCache ? xLogData.constData() : xData.constData())+pos;
+    *ppY = (bLogYCache ? yLogData.constData() : yData.constData())+pos;
+    return qMin(nPoints-i, maxPoints-pos);
+}
+
+
+quint64
+DataStream2D::added() const {
+    return pSource ? pSource->added() : nAdded;
+}
+
+
 void
 DataStream2D::AddPoint(double x, double y) {
-    m_pointArrayX.append(x);
-    m_pointArrayY.append(y);
-    if(m_pointArrayX.count() == 1) {
-        minx = x-DBL_MIN;
-        maxx = x+DBL_MIN;
-        miny = y-DBL_MIN;
-        maxy = y+DBL_MIN;
-    }
-    if(m_pointArrayX.count() > maxPoints) {
-        m_pointArrayX.remove(0, 1);
-        m_pointArrayY.remove(0, 1);
-        minx = x-DBL_MIN;
-        maxx = x+DBL_MIN;
-        miny = y-DBL_MIN;
-        maxy = y+DBL_MIN;
-        for(int i=0; i<m_pointArrayX.count(); i++) {
-            if(m_pointArrayX.at(i) < minx) minx = m_pointArrayX.at(i);
-            if(m_pointArrayX.at(i) > maxx) maxx = m_pointArrayX.at(i);
-            if(m_pointArrayY.at(i) < miny) miny = m_pointArrayY.at(i);
-            if(m_pointArrayY.at(i) > maxy) maxy = m_pointArrayY.at(i);
+    if(pSource) return;
+    append(x, y);
+    updateBounds();
+}
+
+
+// A whole batch with a single update of the bounds.
+// Samples with a NaN ordinate are skipped, as in Plot2D::NewPoint().
+void
+DataStream2D::AddPoints(const double* pX, const double* pY, int n) {
+    if(pSource) return;
+    for(int i=0; i<n; i++) {
+        if(!qIsNaN(pY[i]))
+            append(pX[i], pY[i]);
+    }
+    updateBounds();
+}
+
+
+// O(1): the oldest sample is overwritten and the extrema are
+// maintained by the running queues, with no rescan.
+void
+DataStream2D::append(double x, double y) {
+    if(nPoints == maxPoints) {
+        quint64 oldest = nAdded-quint64(nPoints);
+        xMin.evict(oldest);
+        xMax.evict(oldest);
+        yMin.evict(oldest);
+        yMax.evict(oldest);
+        logXMin.evict(oldest);
+        logXMax.evict(oldest);
+        logYMin.evict(oldest);
+        logYMax.evict(oldest);
+        if(++first == maxPoints) first = 0;
+        nPoints--;
+    }
+    int pos = slot(nPoints);
+    xData[pos] = x;
+    yData[pos] = y;
+    nPoints++;
+    xMin.push(nAdded, x);
+    xMax.push(nAdded, x);
+    yMin.push(nAdded, y);
+    yMax.push(nAdded, y);
+    if(bLogXCache || bLogYCache)
+        storeLog(pos, nAdded, x, y);
+    nAdded++;
+    if(pHistory)
+        pHistory->append(x, y);
+}
+
+
+void
+DataStream2D::updateBounds() {
+    if(pSource) {
+        minx = pSource->minX();
+        maxx = pSource->maxX();
+        miny = pSource->minY(iChannel);
+        maxy = pSource->maxY(iChannel);
+        return;
+    }
+    // NaN while the window is empty
+    minx = xMin.isEmpty() ? qQNaN() : xMin.value();
+    maxx = xMax.isEmpty() ? qQNaN() : xMax.value();
+    miny = yMin.isEmpty() ? qQNaN() : yMin.value();
+    maxy = yMax.isEmpty() ? qQNaN() : yMax.value();
+    minLogX = logXMin.isEmpty() ? qQNaN() : logXMin.value();
+    maxLogX = logXMax.isEmpty() ? qQNaN() : logXMax.value();
+    minLogY = logYMin.isEmpty() ? qQNaN() : logYMin.value();
+    maxLogY = logYMax.isEmpty() ? qQNaN() : logYMax.value();
+}
+
+
+// Enabled while the Data Set is shown on a log axis: the paints then
+// map the cached log10 values linearly instead of computing log10 for
+// every sample at every paint.
+void
+DataStream2D::setLogCache(bool bLogX, bool bLogY) {
+    if(pSource) return;
+    if((bLogX == bLogXCache) && (bLogY == bLogYCache))
+        return;
+    bLogXCache = bLogX;
+    bLogYCache = bLogY;
+    rebuildLogCache();
+}
+
+
+bool
+DataStream2D::hasLogX() const {
+    return bLogXCache;
+}
+
+
+bool
+DataStream2D::hasLogY() const {
+    return bLogYCache;
+}
+
+
+void
+DataStream2D::rebuildLogCache() {
+    xLogData = bLogXCache ? QVector<double>(maxPoints) : QVector<double>();
+    yLogData = bLogYCache ? QVector<double>(maxPoints) : QVector<double>();
+    logXMin.reset(bLogXCache ? maxPoints : 0);
+    logXMax.reset(bLogXCache ? maxPoints : 0);
+    logYMin.reset(bLogYCache ? maxPoints : 0);
+    logYMax.reset(bLogYCache ? maxPoints : 0);
+    quint64 oldest = nAdded-quint64(nPoints);
+    if(bLogXCache || bLogYCache) {
+        for(int i=0; i<nPoints; i++)
+            storeLog(slot(i), oldest+quint64(i), x(i), y(i));
+    }
+    if(nPoints > 0)
+        updateBounds();
+}
+
+
+// Only the positive samples enter the log10 extrema
+void
+DataStream2D::storeLog(int pos, quint64 sequence, double x, double y) {
+    if(bLogXCache) {
+        double value = (x > 0.0) ? log10(x) : qQNaN();
+        xLogData[pos] = value;
+        if(x > 0.0) {
+            logXMin.push(sequence, value);
+            logXMax.push(sequence, value);
         }
     }
-    else {
-        minx = minx < x ? minx : x-DBL_MIN;
-        maxx = maxx > x ? maxx : x+DBL_MIN;
-        miny = miny < y ? miny : y-DBL_MIN;
-        maxy = maxy > y ? maxy : y+DBL_MIN;
+    if(bLogYCache) {
+        double value = (y > 0.0) ? log10(y) : qQNaN();
+        yLogData[pos] = value;
+        if(y > 0.0) {
+            logYMin.push(sequence, value);
+            logYMax.push(sequence, value);
+        }
     }
 }
 
@@ -102,8 +446,30 @@ DataStream2D::GetId() {
 
 void
 DataStream2D::RemoveAllPoints() {
-    m_pointArrayX.clear();
-    m_pointArrayY.clear();
+    // Clears all the channels of a shared source
+    if(pSource) {
+        pSource->RemoveAllPoints();
+        return;
+    }
+    resetRing();
+    if(pHistory)
+        pHistory->clear();
+}
+
+
+void
+DataStream2D::resetRing() {
+    first   = 0;
+    nPoints = 0;
+    nAdded  = 0;
+    xMin.reset(maxPoints);
+    xMax.reset(maxPoints);
+    yMin.reset(maxPoints);
+    yMax.reset(maxPoints);
+    logXMin.reset(bLogXCache ? maxPoints : 0);
+    logXMax.reset(bLogXCache ? maxPoints : 0);
+    logYMin.reset(bLogYCache ? maxPoints : 0);
+    logYMax.reset(bLogYCache ? maxPoints : 0);
 }
 
 
@@ -139,13 +505,42 @@ DataStream2D::GetTitle() {
 
 
 void
-DataStream2D::setMaxPoints(int nPoints) {
-    maxPoints = nPoints;
+DataStream2D::setMaxPoints(int nNewMax) {
+    if(pSource) {
+        pSource->setMaxPoints(nNewMax);
+        return;
+    }
+    if((nNewMax < 1) || (nNewMax == maxPoints))
+        return;
+    // Keep the most recent samples that still fit
+    int nKept = qMin(nPoints, nNewMax);
+    QVector<double> newX(nNewMax);
+    QVector<double> newY(nNewMax);
+    for(int i=0; i<nKept; i++) {
+        newX[i] = x(nPoints-nKept+i);
+        newY[i] = y(nPoints-nKept+i);
+    }
+    maxPoints = nNewMax;
+    resetRing(); // The history is kept
+    xData = newX;
+    yData = newY;
+    nPoints = nKept;
+    for(int i=0; i<nKept; i++) {
+        xMin.push(nAdded, newX.at(i));
+        xMax.push(nAdded, newX.at(i));
+        yMin.push(nAdded, newY.at(i));
+        yMax.push(nAdded, newY.at(i));
+        nAdded++;
+    }
+    if(bLogXCache || bLogYCache)
+        rebuildLogCache();
+    else if(nKept > 0)
+        updateBounds();
 }
 
 
 int
 DataStream2D::getMaxPoints() {
-    return maxPoints;
+    return pSource ? pSource->getMaxPoints() : maxPoints;
 }
 
@@ -22,6 +22,35 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QColor>
 
 #include "DataSetProperties.h"
+#include "minmaxpyramid.h"
+
+
+class MultiChannelStream;
+
+
+// Minimum (or maximum) over a sliding window of samples, kept as a
+// monotonic queue: amortized O(1) per sample, the queue never holds
+// more elements than the window.
+class RunningExtremum
+{
+public:
+    explicit RunningExtremum(bool bMaximum);
+    void   reset(int windowSize);
+    void   push(quint64 sequence, double value);
+    void   evict(quint64 sequence);
+    // Drops every value pushed before the given sequence
+    void   evictBefore(quint64 sequence);
+    double value() const;
+    bool   isEmpty() const;
+
+private:
+    QVector<quint64> sequences;
+    QVector<double>  values;
+    int  first;
+    int  n;
+    bool bMax;
+};
+
 
 class DataStream2D
 {
@@ -33,6 +62,7 @@ public:
     void setMaxPoints(int nPoints);
     int  getMaxPoints();
     void AddPoint(double pointX, double pointY);
+    void AddPoints(const double* pX, const double* pY, int n);
     void RemoveAllPoints();
     int  GetId();
     QString GetTitle();
@@ -42,19 +72,71 @@ public:
     void SetShowTitle(bool show);
     void SetTitle(QString myTitle);
     void SetShow(bool);
+    // Samples are indexed from the oldest (0) to the newest (count()-1)
+    int    count() const;
+    double x(int i) const;
+    double y(int i) const;
+    // The longest run of samples, starting from the i-th, contiguous in memory
+    // (the float overload for a source storing its values as float)
+    int    contiguous(int i, const double** ppX, const double** ppY) const;
+    int    contiguous(int i, const double** ppX, const float** ppY) const;
+    bool   floatValues() const;
+    // Samples added since the last RemoveAllPoints()
+    quint64 added() const;
+    // Whole session history (the X must not decrease)
+    void   setHistory(bool bEnable);
+    const MinMaxPyramid* history() const;
+    // The samples become a channel of a shared stream (not owned):
+    // AddPoint() is ignored, the rows are added to the stream
+    void   setSource(MultiChannelStream* pStream, int channel);
+    MultiChannelStream* source() const;
+    // Refreshes minx, maxx, miny and maxy (and the log10 extrema)
+    void   updateBounds();
+    // log10 columns, filled as the samples arrive, for the log axes.
+    // Not kept for the samples of a shared source.
+    void   setLogCache(bool bLogX, bool bLogY);
+    bool   hasLogX() const;
+    bool   hasLogY() const;
+    // As contiguous(), with the cached axes in log10 (NaN if not positive)
+    int    contiguousLog(int i, const double** ppX, const double** ppY) const;
+
+ protected:
+    int  slot(int i) const;
+    void append(double x, double y);
+    void resetRing();
+    void rebuildLogCache();
+    void storeLog(int pos, quint64 sequence, double x, double y);
 
  // Attributes
  public:
-    QVector<double> m_pointArrayX;
-    QVector<double> m_pointArrayY;
     double minx;
     double maxx;
     double miny;
     double maxy;
+    // log10 extrema of the positive samples, NaN if none (or not cached)
+    double minLogX, maxLogX;
+    double minLogY, maxLogY;
     bool bShowCurveTitle;
     bool isShown;
 
  protected:
     DataSetProperties Properties;
     int maxPoints;
+    // Circular buffer of the last maxPoints samples
+    QVector<double> xData;
+    QVector<double> yData;
+    int     first;
+    int     nPoints;
+    quint64 nAdded;
+    RunningExtremum xMin, xMax, yMin, yMax;
+    bool bLogXCache, bLogYCache;
+    QVector<double> xLogData;
+    QVector<double> yLogData;
+    RunningExtremum logXMin, logXMax, logYMin, logYMax;
+    MinMaxPyramid* pHistory;
+    MultiChannelStream* pSource;
+    int iChannel;
+
+ private:
+    Q_DISABLE_COPY(DataStream2D)
 };
@@ -0,0 +1,232 @@
+#include "latencystats.h"
+
+#include <time.h>
+
+
+static const double blockLength = 1000.0; // Device ms
+static const double maxGap      = 10000.0;
+
+
+int64_t
+monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec)*1000000000 + int64_t(ts.tv_nsec);
+}
+
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+
+void
+LatencyHistogram::reset() {
+    for(int i=0; i<nBuckets; i++)
+        counts[i] = 0;
+    nSamples = 0;
+    minValue = INT64_MAX;
+    maxValue = 0;
+    sum      = 0.0;
+}
+
+
+int
+LatencyHistogram::bucketOf(int64_t ns) {
+    const int64_t linear = int64_t(1) << subBucketBits;
+    if(ns < linear)
+        return int(ns);
+    int exponent = 63 - __builtin_clzll(uint64_t(ns));
+    if(exponent > maxExponent)
+        return nBuckets-1;
+    int shift = exponent - (subBucketBits-1);
+    int half  = 1 << (subBucketBits-1);
+    return int(linear) + (exponent-subBucketBits)*half + int(ns >> shift) - half;
+}
+
+
+int64_t
+LatencyHistogram::lowerBound(int iBucket) {
+    const int linear = 1 << subBucketBits;
+    if(iBucket < linear)
+        return iBucket;
+    int half     = 1 << (subBucketBits-1);
+    int exponent = subBucketBits + (iBucket-linear)/half;
+    int sub      = half + (iBucket-linear)%half;
+    return int64_t(sub) << (exponent-(subBucketBits-1));
+}
+
+
+int64_t
+LatencyHistogram::upperBound(int iBucket) {
+    if(iBucket == nBuckets-1)
+        return INT64_MAX;
+    return lowerBound(iBucket+1) - 1;
+}
+
+
+void
+LatencyHistogram::record(int64_t ns) {
+    if(ns < 0) ns = 0;
+    counts[bucketOf(ns)]++;
+    nSamples++;
+    if(ns < minValue) minValue = ns;
+    if(ns > maxValue) maxValue = ns;
+    sum += double(ns);
+}
+
+
+uint64_t
+LatencyHistogram::count() const {
+    return nSamples;
+}
+
+
+int64_t
+LatencyHistogram::minimum() const {
+    return nSamples ? minValue : 0;
+}
+
+
+int64_t
+LatencyHistogram::maximum() const {
+    return maxValue;
+}
+
+
+double
+LatencyHistogram::mean() const {
+    return nSamples ? sum/double(nSamples) : 0.0;
+}
+
+
+int64_t
+LatencyHistogram::percentile(double fraction) const {
+    if(nSamples == 0)
+        return 0;
+    uint64_t target = uint64_t(fraction*double(nSamples) + 0.5);
+    if(target < 1) target = 1;
+    uint64_t running = 0;
+    for(int i=0; i<nBuckets; i++) {
+        running += counts[i];
+        if(running >= target)
+            return upperBound(i) < maxValue ? upperBound(i) : maxValue;
+    }
+    return maxValue;
+}
+
+
+uint64_t
+LatencyHistogram::countAt(int iBucket) const {
+    return counts[iBucket];
+}
+
+
+ClockSync::ClockSync() {
+    reset();
+}
+
+
+void
+ClockSync::reset() {
+    bStarted = false;
+    bFitted  = false;
+    nStored  = 0;
+    iNext    = 0;
+    a = b    = 0.0;
+}
+
+
+int64_t
+ClockSync::update(double deviceMs, int64_t hostNs) {
+    // A restarted (or a different) Buggy: start over
+    if(bStarted && ((deviceMs < lastDeviceMs) || (deviceMs-lastDeviceMs > maxGap)))
+        reset();
+    if(!bStarted) {
+        firstHostNs   = hostNs;
+        firstDeviceMs = deviceMs;
+        blockStartMs  = 0.0;
+        blockMin      = 1.0e300;
+        blockMinAt    = 0.0;
+        bStarted      = true;
+    }
+    lastDeviceMs = deviceMs;
+    double t = deviceMs - firstDeviceMs;
+    double d = double(hostNs-firstHostNs)*1.0e-6 - t;
+
+    if(d < blockMin) {
+        blockMin   = d;
+        blockMinAt = t;
+    }
+    if(t-blockStartMs >= blockLength) {
+        blockT[iNext] = blockMinAt;
+        blockD[iNext] = blockMin;
+        iNext = (iNext+1) % nBlocks;
+        if(nStored < nBlocks) nStored++;
+        blockStartMs = t;
+        blockMin     = d;
+        blockMinAt   = t;
+        fit();
+    }
+
+    double baseline;
+    if(bFitted)
+        baseline = a + b*t;
+    else
+        baseline = blockMin;
+    // Never below the envelope of the current block
+    if(blockMin < baseline)
+        baseline = blockMin;
+    double delay = d - baseline;
+    return delay > 0.0 ? int64_t(delay*1.0e6) : 0;
+}
+
+
+void
+ClockSync::fit() {
+    if(nStored < 2) {
+        a = blockD[0];
+        b = 0.0;
+        bFitted = true;
+        return;
+    }
+    double st = 0.0, sd = 0.0;
+    for(int i=0; i<nStored; i++) {
+        st += blockT[i];
+        sd += blockD[i];
+    }
+    double tMean = st/nStored;
+    double dMean = sd/nStored;
+    double stt = 0.0, std = 0.0;
+    for(int i=0; i<nStored; i++) {
+        stt += (blockT[i]-tMean)*(blockT[i]-tMean);
+        std += (blockT[i]-tMean)*(blockD[i]-dMean);
+    }
+    b = (stt > 0.0) ? std/stt : 0.0;
+    // Shift the line down to the lowest block minimum: an envelope, not a mean
+    double shift = 0.0;
+    for(int i=0; i<nStored; i++) {
+        double residual = blockD[i] - (dMean + b*(blockT[i]-tMean));
+        if(residual < shift) shift = residual;
+    }
+    a = dMean - b*tMean + shift;
+    bFitted = true;
+}
+
+
+bool
+ClockSync::isValid() const {
+    return bFitted;
+}
+
+
+double
+ClockSync::offsetMs() const {
+    return double(firstHostNs)*1.0e-6 + a - (1.0+b)*firstDeviceMs;
+}
+
+
+double
+ClockSync::driftPpm() const {
+    return b*1.0e6;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Nanoseconds from CLOCK_MONOTONIC: the time base of every host stamp
+int64_t monotonicNs();
+
+
+// HDR-style histogram of latencies in ns: linear up to 2^subBucketBits,
+// then 2^(subBucketBits-1) buckets per power of two (about 3% resolution)
+// up to ~18 minutes. Recording is a handful of integer operations and
+// never allocates.
+class LatencyHistogram
+{
+public:
+    static const int subBucketBits = 6;
+    static const int maxExponent   = 40;
+    static const int nBuckets      = (1 << subBucketBits) +
+                                     (maxExponent-subBucketBits+1) * (1 << (subBucketBits-1));
+
+    LatencyHistogram();
+    void     reset();
+    void     record(int64_t ns);
+    uint64_t count() const;
+    int64_t  minimum() const;
+    int64_t  maximum() const;
+    double   mean() const;
+    // Upper bound of the bucket holding the given fraction (0..1) of the samples
+    int64_t  percentile(double fraction) const;
+    uint64_t countAt(int iBucket) const;
+    static int64_t lowerBound(int iBucket);
+    static int64_t upperBound(int iBucket);
+
+protected:
+    static int bucketOf(int64_t ns);
+
+private:
+    uint64_t counts[nBuckets];
+    uint64_t nSamples;
+    int64_t  minValue;
+    int64_t  maxValue;
+    double   sum;
+};
+
+
+// Maps the Buggy "T" millisecond counter on the host monotonic clock.
+// The host stamp of a record is  device time * (1+drift) + offset + delay:
+// the offset and the drift are fitted on the lower envelope of
+// (host stamp - device time), taken as its minimum over 1 s blocks.
+// The one-way delay of the fastest records is not observable, so the
+// delay returned is measured above it.
+class ClockSync
+{
+public:
+    ClockSync();
+    void    reset();
+    // Returns the estimated delay (ns) of the record
+    int64_t update(double deviceMs, int64_t hostNs);
+    bool    isValid() const;
+    double  offsetMs() const;  // Host ms at device time 0
+    double  driftPpm() const;  // Device clock running slower than the host
+
+protected:
+    void    fit();
+
+private:
+    static const int nBlocks = 16;
+    int64_t firstHostNs;
+    double  firstDeviceMs;
+    double  lastDeviceMs;
+    double  blockStartMs;
+    double  blockMin;           // Min of (host-device) in the current block (ms)
+    double  blockMinAt;         // Device time of that minimum (ms)
+    double  blockT[nBlocks];
+    double  blockD[nBlocks];
+    int     nStored;
+    int     iNext;
+    double  a, b;               // host-device = a + b*device (relative ms)
+    bool    bStarted;
+    bool    bFitted;
+};
@@ -0,0 +1,97 @@
+#include "lineframer.h"
+
+#include <string.h>
+
+
+LineFramer::LineFramer()
+    : delimiter('\n')
+    , nOverflows(0)
+{
+    static_assert((capacity & (capacity-1)) == 0,
+                  "LineFramer capacity must be a power of two");
+    reset();
+}
+
+
+void
+LineFramer::reset() {
+    head = 0;
+    tail = 0;
+    scan = 0;
+    bDiscarding = false;
+}
+
+
+void
+LineFramer::setDelimiter(char newDelimiter) {
+    delimiter = newDelimiter;
+}
+
+
+unsigned long long
+LineFramer::overflows() const {
+    return nOverflows;
+}
+
+
+char*
+LineFramer::writeBuffer(size_t* pFree) {
+    if(head-tail == capacity) {
+        // A line longer than the whole ring: discard it and resync
+        // on the next delimiter (its remaining bytes are dropped too).
+        nOverflows++;
+        tail = scan = head;
+        bDiscarding = true;
+    }
+    size_t pos = head & (capacity-1);
+    size_t nFree = capacity - (head-tail);
+    if(nFree > capacity-pos)
+        nFree = capacity-pos;
+    *pFree = nFree;
+    return buffer+pos;
+}
+
+
+void
+LineFramer::commit(size_t nBytes) {
+    head += nBytes;
+}
+
+
+bool
+LineFramer::nextLine(std::string_view* pLine) {
+    while(scan != head) {
+        size_t pos = scan & (capacity-1);
+        size_t nBytes = head-scan;
+        if(nBytes > capacity-pos)
+            nBytes = capacity-pos;
+        const char* pEnd = static_cast<const char*>(memchr(buffer+pos, delimiter, nBytes));
+        if(!pEnd) {
+            scan += nBytes;
+            if(bDiscarding)
+                tail = scan;
+            continue;
+        }
+        size_t end    = scan + size_t(pEnd-(buffer+pos));
+        if(bDiscarding) {
+            // The tail of the overlong line, delimiter included
+            tail = scan = end+1;
+            bDiscarding = false;
+            continue;
+        }
+        size_t length = end-tail;
+        size_t start  = tail & (capacity-1);
+        if(start+length <= capacity) {
+            *pLine = std::string_view(buffer+start, length);
+        }
+        else {
+            size_t first = capacity-start;
+            memcpy(lineBuffer, buffer+start, first);
+            memcpy(lineBuffer+first, buffer, length-first);
+            *pLine = std::string_view(lineBuffer, length);
+        }
+        tail = scan = end+1;
+        return true;
+    }
+    return false;
+}
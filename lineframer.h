@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string_view>
+#include <cstddef>
+
+
+// Fixed capacity byte ring splitting the incoming stream into lines
+// (or into packets ended by any other delimiter byte).
+// Bytes are written in place (no intermediate buffers) and the lines
+// are returned as non-owning views: nothing is allocated after the
+// construction.
+class LineFramer
+{
+public:
+    static const size_t capacity = 16384; // Must be a power of two
+
+    LineFramer();
+    void  reset();
+    // May be changed between two nextLine() to switch framing on the fly
+    void  setDelimiter(char newDelimiter);
+    // Contiguous free space where the next incoming bytes can be written
+    char* writeBuffer(size_t* pFree);
+    void  commit(size_t nBytes);
+    // The view is valid until the next call to nextLine() or commit()
+    bool  nextLine(std::string_view* pLine);
+    unsigned long long overflows() const;
+
+private:
+    char   buffer[capacity];
+    char   lineBuffer[capacity]; // Linearized copy of a line wrapping around
+    size_t head;                 // Free running write position
+    size_t tail;                 // Start of the current (incomplete) line
+    size_t scan;                 // First byte not yet searched for the delimiter
+    char   delimiter;
+    bool   bDiscarding;          // Dropping the rest of an overlong line
+    unsigned long long nOverflows;
+};
@@ -7,6 +7,9 @@
 #include <compass.h>
 #include <dashboardwidget.h>
 #include <controlsdialog.h>
+#include <renderscheduler.h>
+#include <commandqueue.h>
+#include <multichannelstream.h>
 
 
 #include <QSettings>
@@ -14,6 +17,16 @@
 #include <QKeyEvent>
 #include <QPushButton>
 #include <QSlider>
+#include <QComboBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSerialPortInfo>
+#include <QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QDir>
 #include <QMessageBox>
 #include <QThread>
 #include <QtMath>
@@ -22,6 +35,10 @@
 double testAngle = 0.0;
 QVector3D testPos = QVector3D(0.0, 0.0, 0.0);
 
+// Reconnection attempts back off exponentially between these (ms)
+static const int minReconnectDelay = 250;
+static const int maxReconnectDelay = 8000;
+
 
 MainWindow::MainWindow(QWidget *parent)
     : QWidget(parent)
@@ -29,9 +46,12 @@ MainWindow::MainWindow(QWidget *parent)
     , pDashboardWidget(nullptr)
     , pLeftPlot(nullptr)
     , pRightPlot(nullptr)
+    , pLeftStream(nullptr)
+    , pRightStream(nullptr)
+    , pRenderScheduler(nullptr)
+    , pCommandQueue(nullptr)
     , pPIDControlsDialog(nullptr)
     , serialPortName(QString("/dev/ttyACM0"))
-    , receivedData(QString())
     , quat0(QQuaternion(1.0, 0.0, 0.0, 0.0).conjugated())
     , t0(-1.0)
     , LSpeed(0.0)
@@ -39,6 +59,16 @@ MainWindow::MainWindow(QWidget *parent)
     , iSign(1)
 {
     baudRate = QSerialPort::Baud9600;
+    reconnectDelay = minReconnectDelay;
+    lastBytes  = 0;
+    lastFrames = 0;
+    bObstacleDistanceChanged = false;
+    renderPending.reserve(4096);
+    plotTime.reserve(4096);
+    leftSpeedSamples.reserve(4096);
+    leftSetPtSamples.reserve(4096);
+    rightSpeedSamples.reserve(4096);
+    rightSetPtSamples.reserve(4096);
 
     eyePos    = QVector3D(0.0, 30.0, 50.0);
     centerPos = QVector3D(0.0,  0.0,  0.0);
@@ -47,12 +77,33 @@ MainWindow::MainWindow(QWidget *parent)
     setWindowIcon(QIcon(":/plot.png"));
     initLayout();
     onResetCameraPushed();
+    // Every telemetry driven repaint goes through the scheduler
+    pRenderScheduler = new RenderScheduler(this);
     restoreSettings();
     pPIDControlsDialog = new ControlsDialog();
+
+    // The Serial Port is served by its own thread: the GUI only
+    // drains the already parsed frames, once per frame.
+    pTelemetryRing = new TelemetryRing();
+    pSerialReader = new SerialReader(pTelemetryRing);
+    pSerialReader->moveToThread(&readerThread);
+    connect(&readerThread, SIGNAL(finished()),
+            pSerialReader, SLOT(deleteLater()));
+    readerThread.start(QThread::HighPriority);
+    // Parameter updates leave coalesced, every 50 ms
+    pCommandQueue = new CommandQueue(50, this);
+    QSettings settings;
+    QMetaObject::invokeMethod(pSerialReader, "setBinaryFraming", Qt::QueuedConnection,
+                              Q_ARG(bool, settings.value("BinaryFraming", false).toBool()));
+
     connectSignals();
     disableUI();
     pStatusBar->showMessage(QString("Wait: Connecting to Buggy..."));
-    connectionTimer.start(500);
+    pRenderScheduler->start();
+    linkMeterTimer.start(1000);
+    linkMeterClock.start();
+    connectionTimer.setSingleShot(true);
+    startReconnecting();
 
 //    car.SetPosition(QVector3D(3.0, 0.0, -1.5));
 //    car.SetAngle(5.0);
@@ -83,6 +134,12 @@ MainWindow::onTestTimerElapsed() {
 
 
 MainWindow::~MainWindow() {
+    readerThread.quit();
+    readerThread.wait();
+    delete pTelemetryRing;
+    closeSession();
+    delete pLeftStream;
+    delete pRightStream;
 }
 
 
@@ -102,8 +159,8 @@ MainWindow::closeEvent(QCloseEvent *event) {
             pPIDControlsDialog->close();
             delete pPIDControlsDialog;
         }
-        if(serialPort.isOpen())
-            serialPort.close();
+        QMetaObject::invokeMethod(pSerialReader, "closePort",
+                                  Qt::BlockingQueuedConnection);
         event->accept();
     }
     else {
@@ -132,6 +189,18 @@ void
 MainWindow::restoreSettings() {
     QSettings settings;
     restoreGeometry(settings.value("Geometry").toByteArray());
+    serialPortName = settings.value("SerialPort", serialPortName).toString();
+    baudRate       = settings.value("BaudRate", baudRate).toInt();
+    refreshPortList();
+    int iBaud = pComboBaud->findData(baudRate);
+    if(iBaud < 0) {
+        pComboBaud->addItem(QString("%1").arg(baudRate), baudRate);
+        iBaud = pComboBaud->count()-1;
+    }
+    pComboBaud->setCurrentIndex(iBaud);
+    int iRefresh = pComboRefresh->findData(settings.value("RefreshRate", 60).toInt());
+    pComboRefresh->setCurrentIndex(iRefresh < 0 ? 0 : iRefresh);
+    pRenderScheduler->setRefreshRate(pComboRefresh->currentData().toInt());
 }
 
 
@@ -140,25 +209,203 @@ MainWindow::saveSettings() {
     QSettings settings;
     // Window Position and Size
     settings.setValue("Geometry", saveGeometry());
+    // Serial Link
+    settings.setValue("SerialPort", serialPortName);
+    settings.setValue("BaudRate", baudRate);
+    // Telemetry Repaint Rate
+    settings.setValue("RefreshRate", pComboRefresh->currentData().toInt());
 }
 
 
-bool
+void
 MainWindow::serialConnect() {
-    serialPort.setPortName(serialPortName);
-    if(serialPort.isOpen())
-        serialPort.close();
-    if(!serialPort.open(QIODevice::ReadWrite)) {
-        pStatusBar->showMessage(QString("No Buggy Connected Till Now..."));
-        return false;
+    // The result will be notified by onPortOpened()
+    emit openSerialPort(serialPortName, baudRate);
+}
+
+
+void
+MainWindow::startReconnecting() {
+    reconnectDelay = minReconnectDelay;
+    connectionTimer.start(reconnectDelay);
+}
+
+
+void
+MainWindow::onPortOpened(bool bSuccess) {
+    if(!bSuccess) {
+        pStatusBar->showMessage(QString("No Buggy Connected Till Now... (retry in %1 s)")
+                                .arg(reconnectDelay/1000.0, 0, 'f', 2));
+        connectionTimer.start(reconnectDelay);
+        reconnectDelay = qMin(2*reconnectDelay, maxReconnectDelay);
+        return;
     }
-    serialPort.setBaudRate(baudRate);
-    serialPort.setParent(this);
-    serialPort.readAll(); // Discard Input Buffer
-    connect(&serialPort, SIGNAL(readyRead()),
-            this, SLOT(onNewDataAvailable()));
-    pStatusBar->showMessage(QString("Buggy Ready to Connect via ttyACM0"));
+    connectionTimer.stop();
+    reconnectDelay = minReconnectDelay;
+    pStatusBar->showMessage(QString("Buggy Ready to Connect via %1").arg(serialPortName));
+    bConnected = false;
+    resetLatency();
+}
+
+
+void
+MainWindow::onPortLost() {
     bConnected = false;
+    keepAliveTimer.stop();
+    changeSpeedTimer.stop();
+    steadyTimer.stop();
+    disableUI();
+    pButtonConnect->setText("Connect");
+    pButtonStartStop->setText("Start");
+    pStatusBar->showMessage(QString("Buggy Lost: %1 Disappeared !").arg(serialPortName));
+    startReconnecting();
+}
+
+
+void
+MainWindow::refreshPortList() {
+    QStringList portNames;
+    const QList<QSerialPortInfo> ports = QSerialPortInfo::availablePorts();
+    for(const QSerialPortInfo& portInfo : ports)
+        portNames.append(portInfo.systemLocation());
+    // Keep also a not (yet) existing port: e.g. the pty of the emulator
+    if(!portNames.contains(serialPortName))
+        portNames.append(serialPortName);
+    QStringList currentNames;
+    for(int i=0; i<pComboPort->count(); i++)
+        currentNames.append(pComboPort->itemText(i));
+    if(currentNames != portNames) {
+        pComboPort->blockSignals(true);
+        pComboPort->clear();
+        pComboPort->addItems(portNames);
+        pComboPort->blockSignals(false);
+    }
+    if(!pComboPort->lineEdit()->hasFocus()) // The user may be typing
+        pComboPort->setCurrentText(serialPortName);
+}
+
+
+void
+MainWindow::onPortSelected() {
+    QString sNewPort = pComboPort->currentText().trimmed();
+    if(sNewPort.isEmpty() || (sNewPort == serialPortName))
+        return;
+    serialPortName = sNewPort;
+    keepAliveTimer.stop();
+    changeSpeedTimer.stop();
+    steadyTimer.stop();
+    disableUI();
+    pButtonConnect->setText("Connect");
+    pButtonStartStop->setText("Start");
+    pStatusBar->showMessage(QString("Wait: Connecting to Buggy via %1...").arg(serialPortName));
+    startReconnecting();
+}
+
+
+void
+MainWindow::onBaudRateSelected() {
+    baudRate = pComboBaud->currentData().toInt();
+    emit changeBaudRate(baudRate);
+}
+
+
+void
+MainWindow::onRefreshRateSelected() {
+    pRenderScheduler->setRefreshRate(pComboRefresh->currentData().toInt());
+}
+
+
+void
+MainWindow::onUpdateLinkMeter() {
+    double dt = linkMeterClock.restart()/1000.0;
+    if(dt <= 0.0) return;
+    quint64 nBytes  = pSerialReader->bytesReceived();
+    quint64 nFrames = pSerialReader->framesReceived();
+    pLinkMeterLabel->setText(QString("%1 B/s  %2 frames/s  lost:%3  bad:%4")
+                             .arg(double(nBytes-lastBytes)/dt, 0, 'f', 0)
+                             .arg(double(nFrames-lastFrames)/dt, 0, 'f', 0)
+                             .arg(pSerialReader->droppedRecords())
+                             .arg(pSerialReader->corruptedRecords()));
+    lastBytes  = nBytes;
+    lastFrames = nFrames;
+    // p50/p99 in ms
+    pLatencyLabel->setText(QString("link %1/%2  parse %3/%4  render %5/%6 ms")
+                           .arg(linkLatency.percentile(0.5)*1.0e-6, 0, 'f', 2)
+                           .arg(linkLatency.percentile(0.99)*1.0e-6, 0, 'f', 2)
+                           .arg(parseLatency.percentile(0.5)*1.0e-6, 0, 'f', 3)
+                           .arg(parseLatency.percentile(0.99)*1.0e-6, 0, 'f', 3)
+                           .arg(renderLatency.percentile(0.5)*1.0e-6, 0, 'f', 2)
+                           .arg(renderLatency.percentile(0.99)*1.0e-6, 0, 'f', 2));
+}
+
+
+void
+MainWindow::resetLatency() {
+    clockSync.reset();
+    linkLatency.reset();
+    parseLatency.reset();
+    renderLatency.reset();
+    renderPending.clear();
+}
+
+
+void
+MainWindow::recordLatency(const TelemetryFrame& frame) {
+    if(frame.fields & TelemetryFrame::Time)
+        linkLatency.record(clockSync.update(frame.dTime, frame.arrivalNs));
+    parseLatency.record(frame.parsedNs-frame.arrivalNs);
+    if(renderPending.count() < renderPending.capacity())
+        renderPending.append(frame.arrivalNs);
+}
+
+
+void
+MainWindow::onFrameRendered() {
+    int64_t renderedNs = monotonicNs();
+    for(int i=0; i<renderPending.count(); i++)
+        renderLatency.record(renderedNs-renderPending.at(i));
+    renderPending.clear();
+}
+
+
+void
+MainWindow::onSaveLatencyPushed() {
+    QString sFileName = QFileDialog::getSaveFileName(this, "Save Latency Histograms",
+                                                     "latency.csv", "CSV (*.csv)");
+    if(sFileName.isEmpty())
+        return;
+    if(!saveLatency(sFileName))
+        pStatusBar->showMessage(QString("Unable to write %1").arg(sFileName));
+}
+
+
+bool
+MainWindow::saveLatency(QString sFileName) {
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    QTextStream out(&file);
+    const LatencyHistogram* histograms[] = { &linkLatency, &parseLatency, &renderLatency };
+    const char* names[] = { "link", "parse", "render" };
+    out << "# clock offset [ms]," << QString::number(clockSync.offsetMs(), 'f', 3)
+        << ",drift [ppm]," << QString::number(clockSync.driftPpm(), 'f', 2) << "\n";
+    out << "# histogram,count,min,mean,p50,p90,p99,p99.9,max [ns]\n";
+    for(int i=0; i<3; i++) {
+        const LatencyHistogram* pH = histograms[i];
+        out << "# " << names[i] << "," << pH->count() << "," << pH->minimum() << ","
+            << qint64(pH->mean()) << "," << pH->percentile(0.5) << ","
+            << pH->percentile(0.9) << "," << pH->percentile(0.99) << ","
+            << pH->percentile(0.999) << "," << pH->maximum() << "\n";
+    }
+    out << "histogram,from [ns],to [ns],count\n";
+    for(int i=0; i<3; i++) {
+        for(int j=0; j<LatencyHistogram::nBuckets; j++) {
+            if(histograms[i]->countAt(j) == 0)
+                continue;
+            out << names[i] << "," << LatencyHistogram::lowerBound(j) << ","
+                << LatencyHistogram::upperBound(j) << "," << histograms[i]->countAt(j) << "\n";
+        }
+    }
     return true;
 }
 
@@ -173,6 +420,28 @@ MainWindow::createButtons() {
 }
 
 
+void
+MainWindow::createLinkControls() {
+    const int baudRates[] = {
+        9600, 19200, 38400, 57600, 115200,
+        230400, 460800, 500000, 921600, 1000000
+    };
+    pComboPort = new QComboBox(this);
+    pComboPort->setEditable(true); // Any device path may be entered
+    pComboPort->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    pComboBaud = new QComboBox(this);
+    for(int baud : baudRates)
+        pComboBaud->addItem(QString("%1").arg(baud), baud);
+    pComboRefresh = new QComboBox(this);
+    pComboRefresh->addItem("60 Hz", 60);
+    pComboRefresh->addItem("30 Hz", 30);
+    pComboRefresh->addItem("15 Hz", 15);
+    pLinkMeterLabel = new QLabel(this);
+    pLatencyLabel = new QLabel(this);
+    pButtonSaveLatency = new QPushButton("Latency...", this);
+}
+
+
 void
 MainWindow::initPlots() {
     /////////////////////////
@@ -180,8 +449,12 @@ MainWindow::initPlots() {
     /////////////////////////
     pLeftPlot = new Plot2D(nullptr, "Left Motor");
 
-    pLeftPlot->NewDataSet(1, 2, QColor(128, 128, 255), Plot2D::iline, "SetPt");
-    pLeftPlot->NewDataSet(2, 2, QColor(255, 255,   0), Plot2D::iline, "Speed");
+    // SetPt and Speed share their time column
+    pLeftStream = new MultiChannelStream(2, MultiChannelStream::Float);
+    pLeftPlot->NewDataSet(1, 2, QColor(128, 128, 255), Plot2D::iline, "SetPt")->setSource(pLeftStream, 0);
+    pLeftPlot->NewDataSet(2, 2, QColor(255, 255,   0), Plot2D::iline, "Speed")->setSource(pLeftStream, 1);
+    pLeftStream->setHistory(0, true);
+    pLeftStream->setHistory(1, true);
     pLeftPlot->NewDataSet(3, 2, QColor(  0, 255, 255), Plot2D::iline, "PID-Out");
 
     pLeftPlot->SetShowTitle(1, true);
@@ -193,7 +466,8 @@ MainWindow::initPlots() {
     pLeftPlot->SetShowDataSet(3, true);
 
     pLeftPlot->SetLimits(0.0, 1.0, -1.1, 1.1, true, true, false, false);
-    pLeftPlot->setMaxPoints(600);
+    pLeftPlot->setMaxPoints(20000);
+    pLeftPlot->SetStripChart(true, 10.0);
     pLeftPlot->UpdatePlot();
     pLeftPlot->show();
 
@@ -204,8 +478,11 @@ MainWindow::initPlots() {
     //////////////////////////
     pRightPlot = new Plot2D(nullptr, "Right Motor");
 
-    pRightPlot->NewDataSet(1, 2, QColor(128, 128, 255), Plot2D::iline, "SetPt");
-    pRightPlot->NewDataSet(2, 2, QColor(255, 255,   0), Plot2D::iline, "Speed");
+    pRightStream = new MultiChannelStream(2, MultiChannelStream::Float);
+    pRightPlot->NewDataSet(1, 2, QColor(128, 128, 255), Plot2D::iline, "SetPt")->setSource(pRightStream, 0);
+    pRightPlot->NewDataSet(2, 2, QColor(255, 255,   0), Plot2D::iline, "Speed")->setSource(pRightStream, 1);
+    pRightStream->setHistory(0, true);
+    pRightStream->setHistory(1, true);
     pRightPlot->NewDataSet(3, 2, QColor(  0, 255, 255), Plot2D::iline, "PID-Out");
 
     pRightPlot->SetShowTitle(1, true);
@@ -217,7 +494,8 @@ MainWindow::initPlots() {
     pRightPlot->SetShowDataSet(3, true);
 
     pRightPlot->SetLimits(0.0, 1.0, -1.0, 1.0, true, true, false, false);
-    pRightPlot->setMaxPoints(600);
+    pRightPlot->setMaxPoints(20000);
+    pRightPlot->SetStripChart(true, 10.0);
     pRightPlot->UpdatePlot();
     pRightPlot->show();
 
@@ -250,6 +528,14 @@ MainWindow::initLayout() {
     firstButtonRow->addWidget(pButtonResetCar);
     firstButtonRow->addWidget(pEditObstacleDistance);
 
+    createLinkControls();
+    firstButtonRow->addWidget(pComboPort);
+    firstButtonRow->addWidget(pComboBaud);
+    firstButtonRow->addWidget(pComboRefresh);
+    firstButtonRow->addWidget(pButtonSaveLatency);
+    pStatusBar->addPermanentWidget(pLatencyLabel);
+    pStatusBar->addPermanentWidget(pLinkMeterLabel);
+
     QVBoxLayout *mainLayout = new QVBoxLayout;
     mainLayout->addLayout(firstRow);
     mainLayout->addLayout(firstButtonRow);
@@ -280,6 +566,34 @@ MainWindow::connectSignals() {
             this, SLOT(onSteadyTimeElapsed()));
     connect(&testTimer, SIGNAL(timeout()),
             this, SLOT(onTestTimerElapsed()));
+    connect(pRenderScheduler, SIGNAL(frameStarted()),
+            this, SLOT(onDrainTelemetry()));
+    connect(pRenderScheduler, SIGNAL(frameRendered()),
+            this, SLOT(onFrameRendered()));
+    connect(&linkMeterTimer, SIGNAL(timeout()),
+            this, SLOT(onUpdateLinkMeter()));
+    connect(pButtonSaveLatency, SIGNAL(clicked()),
+            this, SLOT(onSaveLatencyPushed()));
+
+    connect(pComboPort, SIGNAL(activated(int)),
+            this, SLOT(onPortSelected()));
+    connect(pComboPort->lineEdit(), SIGNAL(editingFinished()),
+            this, SLOT(onPortSelected()));
+    connect(pComboBaud, SIGNAL(activated(int)),
+            this, SLOT(onBaudRateSelected()));
+    connect(pComboRefresh, SIGNAL(activated(int)),
+            this, SLOT(onRefreshRateSelected()));
+
+    connect(this, SIGNAL(openSerialPort(QString,int)),
+            pSerialReader, SLOT(openPort(QString,int)));
+    connect(pCommandQueue, SIGNAL(writeToBuggy(QByteArray)),
+            pSerialReader, SLOT(write(QByteArray)));
+    connect(this, SIGNAL(changeBaudRate(int)),
+            pSerialReader, SLOT(setBaudRate(int)));
+    connect(pSerialReader, SIGNAL(portOpened(bool)),
+            this, SLOT(onPortOpened(bool)));
+    connect(pSerialReader, SIGNAL(portLost()),
+            this, SLOT(onPortLost()));
 
     connect(pButtonConnect, SIGNAL(clicked()),
             this, SLOT(onConnectPushed()));
@@ -316,99 +630,121 @@ MainWindow::connectSignals() {
 
 
 void
-MainWindow::processData(QString sData) {
-    bool bUpdateWidget = false;
+MainWindow::processData(const TelemetryFrame& frame) {
     bool bUpdateMotors = false;
-    bool bUpdateObstacleDistance = false;
-    QStringList tokens = sData.split(',');
-    while(!tokens.isEmpty()) {
-        QString sHeader = tokens.first();
-        int nTokens = tokens.length();
-        if(sHeader == "A" && nTokens > 4) {
-            tokens.removeFirst();
-            q0 = tokens.first().toDouble()/1000.0;
-            tokens.removeFirst();
-            q1 = tokens.first().toDouble()/1000.0;
-            tokens.removeFirst();
-            q2 = tokens.first().toDouble()/1000.0;
-            tokens.removeFirst();
-            q3 = tokens.first().toDouble()/1000.0;
-            tokens.removeFirst();
-            pDashboardWidget->pCompass->angle = QQuaternion(q0, q1, q2, q3);
-            bUpdateWidget = true;
-        }
-        else if(sHeader == "M" && nTokens > 4) {
-            tokens.removeFirst();
-            leftSpeed = tokens.first().toDouble()/100.0;
-            tokens.removeFirst();
-            leftPath = tokens.first().toDouble();
-            tokens.removeFirst();
-            rightSpeed = tokens.first().toDouble()/100.0;
-            tokens.removeFirst();
-            rightPath = tokens.first().toDouble();
-            tokens.removeFirst();
-            pRoomWidget->pCar->Move(rightPath, leftPath);
-            bUpdateMotors = true;
-            bUpdateWidget = true;
-        }
-        else if(sHeader == "D") {
-            tokens.removeFirst();
-            obstacleDistance = tokens.first().toDouble();
-            tokens.removeFirst();
-            bUpdateObstacleDistance = true;
-        }
-        else if(sHeader == "T" && nTokens > 1) {
-            tokens.removeFirst();
-            dTime = tokens.first().toDouble();
-            if(t0 < 0)
-                t0 = dTime;
-            if(bUpdateMotors) {
-                double t = (dTime-t0)/1000.0;
-                pLeftPlot->NewPoint(2, t, leftSpeed);
-                pLeftPlot->NewPoint(1, t, LSpeed/100.0);
-                pRightPlot->NewPoint(2, t, rightSpeed);
-                pRightPlot->NewPoint(1, t, RSpeed/100.0);
-            }
-        }
-        else if(sHeader == "P") { // Buggy Asked the PID Parameters
-            tokens.removeFirst();
-            pPIDControlsDialog->sendParams();
-        }
-        else if(sHeader == "Buggy Ready") { // Buggy is Ready to Start
-            pButtonConnect->setEnabled(true);
-            tokens.clear();
-        }
-        else { // Unknown token
-            tokens.removeFirst();
+    if(frame.fields & TelemetryFrame::Attitude) {
+        q0 = frame.q0;
+        q1 = frame.q1;
+        q2 = frame.q2;
+        q3 = frame.q3;
+        pDashboardWidget->pCompass->angle = QQuaternion(q0, q1, q2, q3);
+        pRenderScheduler->markDirty(pDashboardWidget);
+    }
+    if(frame.fields & TelemetryFrame::Motors) {
+        leftSpeed  = frame.leftSpeed;
+        leftPath   = frame.leftPath;
+        rightSpeed = frame.rightSpeed;
+        rightPath  = frame.rightPath;
+        pRoomWidget->pCar->Move(rightPath, leftPath);
+        pRenderScheduler->markDirty(pRoomWidget);
+        bUpdateMotors = true;
+    }
+    if(frame.fields & TelemetryFrame::Obstacle) {
+        obstacleDistance = frame.obstacleDistance;
+        bObstacleDistanceChanged = true;
+    }
+    if(frame.fields & TelemetryFrame::Time) {
+        dTime = frame.dTime;
+        if(t0 < 0)
+            t0 = dTime;
+        if(bUpdateMotors) {
+            plotTime.append((dTime-t0)/1000.0);
+            leftSpeedSamples.append(leftSpeed);
+            leftSetPtSamples.append(LSpeed/100.0);
+            rightSpeedSamples.append(rightSpeed);
+            rightSetPtSamples.append(RSpeed/100.0);
         }
-    } // while(!tokens.isEmpty())
-
-    if(bUpdateMotors) {
-        pLeftPlot->UpdatePlot();
-        pRightPlot->UpdatePlot();
     }
-    if(bUpdateWidget) {
-        pRoomWidget->update();
-        pDashboardWidget->update();
+    if(frame.fields & TelemetryFrame::ParamsRequest) { // Buggy Asked the PID Parameters
+        pPIDControlsDialog->sendParams();
     }
-    if(bUpdateObstacleDistance) {
-        pEditObstacleDistance->setText(QString("%1").arg(obstacleDistance));
+    if(frame.fields & TelemetryFrame::BuggyReady) { // Buggy is Ready to Start
+        pButtonConnect->setEnabled(true);
+    }
+    if(frame.fields & TelemetryFrame::BinaryAck) {
+        pStatusBar->showMessage(QString("Buggy Ready: Binary Telemetry Enabled"));
     }
 }
 
 
+// One bulk append per plot and a single repaint request per drain
 void
-MainWindow::onTryToConnect() {
-    if(serialConnect()) {
-        connectionTimer.stop();
+MainWindow::flushPlotSamples() {
+    int nSamples = plotTime.count();
+    if(nSamples == 0)
+        return;
+    const double* leftValues[2]  = { leftSetPtSamples.constData(),  leftSpeedSamples.constData()  };
+    const double* rightValues[2] = { rightSetPtSamples.constData(), rightSpeedSamples.constData() };
+    pLeftPlot->NewRows(pLeftStream, plotTime.constData(), leftValues, nSamples);
+    pRightPlot->NewRows(pRightStream, plotTime.constData(), rightValues, nSamples);
+    pRenderScheduler->markDirty(pLeftPlot);
+    pRenderScheduler->markDirty(pRightPlot);
+    if(sessionFile.isOpen()) {
+        for(int i=0; i<nSamples; i++) {
+            sessionStream << plotTime.at(i) << ","
+                          << leftSetPtSamples.at(i)  << "," << leftSpeedSamples.at(i)  << ","
+                          << rightSetPtSamples.at(i) << "," << rightSpeedSamples.at(i) << "\n";
+        }
     }
+    plotTime.clear();
+    leftSpeedSamples.clear();
+    leftSetPtSamples.clear();
+    rightSpeedSamples.clear();
+    rightSetPtSamples.clear();
+}
+
+
+// Every run (Start to Stop) is recorded in its own file, to be
+// rendered later with PlotExport
+bool
+MainWindow::openSession() {
+    closeSession();
+    QString sDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)+QString("/sessions");
+    QDir().mkpath(sDir);
+    QString sFileName = QString("%1/Session_%2.csv")
+                        .arg(sDir)
+                        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+    sessionFile.setFileName(sFileName);
+    if(!sessionFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    sessionStream.setDevice(&sessionFile);
+    sessionStream.setRealNumberPrecision(9);
+    sessionStream << "t [s],left setpoint,left speed,right setpoint,right speed\n";
+    return true;
+}
+
+
+void
+MainWindow::closeSession() {
+    if(!sessionFile.isOpen())
+        return;
+    sessionStream.flush();
+    sessionStream.setDevice(nullptr);
+    sessionFile.close();
+}
+
+
+void
+MainWindow::onTryToConnect() {
+    refreshPortList();
+    serialConnect();
 }
 
 
 void
 MainWindow::onConnectPushed() {
     if(pButtonConnect->text() == QString("Connect")) {
-        serialPort.write("K\n"); // Keep Alive message
+        pCommandQueue->sendNow("K\n"); // Keep Alive message
         pPIDControlsDialog->sendParams();
         enableUI();
         keepAliveTimer.start(100);
@@ -422,7 +758,7 @@ MainWindow::onConnectPushed() {
         steadyTimer.stop();
         pButtonConnect->setText("Connect");
         pStatusBar->showMessage(QString("Buggy Disconnected !"));
-        connectionTimer.start(500);
+        startReconnecting();
     }
 }
 
@@ -430,14 +766,14 @@ MainWindow::onConnectPushed() {
 void
 MainWindow::onKeepAlive() {
     if(bConnected) {
-        serialPort.write("K\n");
+        pCommandQueue->sendNow("K\n");
     }
     else {
         keepAliveTimer.stop();
         changeSpeedTimer.stop();
         disableUI();
         pStatusBar->showMessage(QString("Buggy Disconnected !"));
-        connectionTimer.start(500);
+        startReconnecting();
     }
 }
 
@@ -452,10 +788,8 @@ MainWindow::onTimeToChangeSpeed() {
     }
     LSpeed += iSign;
     RSpeed += iSign;
-    QString sMessage = QString("Ls%1\nRs%2\n")
-                       .arg(LSpeed)
-                       .arg(RSpeed);
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::LeftSpeed,  int(LSpeed));
+    pCommandQueue->setValue(CommandQueue::RightSpeed, int(RSpeed));
 }
 
 
@@ -483,15 +817,22 @@ MainWindow::onStartStopPushed() {
         pRightPlot->ClearDataSet(3);
         nRightPlotPoints = 0;
         changeSpeedTimer.start(20);
-        QString sMessage = QString("G\nLs%1\nRs%2\n")
-                           .arg(LSpeed)
-                           .arg(RSpeed);
-        serialPort.write(sMessage.toLatin1().constData());
+        pCommandQueue->sendNow("G\n");
+        pCommandQueue->setValue(CommandQueue::LeftSpeed,  int(LSpeed));
+        pCommandQueue->setValue(CommandQueue::RightSpeed, int(RSpeed));
+        pCommandQueue->flush();
+        if(!openSession())
+            pStatusBar->showMessage(QString("Unable to record the session"));
         pButtonStartStop->setText("Stop");
     }
     else {
         changeSpeedTimer.stop();
-        serialPort.write("H\n");
+        // Halt at once and forget any speed still waiting in the queue
+        pCommandQueue->sendNow("H\n");
+        pCommandQueue->discard(CommandQueue::LeftSpeed);
+        pCommandQueue->discard(CommandQueue::RightSpeed);
+        flushPlotSamples();
+        closeSession();
         pButtonStartStop->setText("Start");
     }
 }
@@ -524,16 +865,18 @@ MainWindow::onHidePIDControls() {
 
 
 void
-MainWindow::onNewDataAvailable() {
-    bConnected = true;
-    receivedData += serialPort.readAll();
-    QString sNewData;
-    int iPos = receivedData.indexOf("\n");
-    while(iPos != -1) {
-        sNewData = receivedData.left(iPos);
-        processData(sNewData);
-        receivedData = receivedData.mid(iPos+1);
-        iPos = receivedData.indexOf("\n");
+MainWindow::onDrainTelemetry() {
+    const TelemetryFrame* pFrame;
+    while((pFrame = pTelemetryRing->front()) != nullptr) {
+        bConnected = true;
+        recordLatency(*pFrame);
+        processData(*pFrame);
+        pTelemetryRing->pop();
+    }
+    flushPlotSamples();
+    if(bObstacleDistanceChanged) {
+        pEditObstacleDistance->setText(QString("%1").arg(obstacleDistance));
+        bObstacleDistanceChanged = false;
     }
 }
 
@@ -541,62 +884,54 @@ MainWindow::onNewDataAvailable() {
 void
 MainWindow::onLPvalueChanged(int value) {
     LPvalue = value;
-    QString sMessage = QString("Lp%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::LeftP, value);
 }
 
 
 void
 MainWindow::onLIvalueChanged(int value) {
     LIvalue = value;
-    QString sMessage = QString("Li%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::LeftI, value);
 }
 
 
 void
 MainWindow::onLDvalueChanged(int value) {
     LDvalue = value;
-    QString sMessage = QString("Ld%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::LeftD, value);
 }
 
 
 void
 MainWindow::onLSpeedChanged(int value) {
     LSpeed = value;
-    QString sMessage = QString("Ls%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::LeftSpeed, value);
 }
 
 
 void
 MainWindow::onRPvalueChanged(int value) {
     RPvalue = value;
-    QString sMessage = QString("Rp%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::RightP, value);
 }
 
 
 void
 MainWindow::onRIvalueChanged(int value) {
     RIvalue = value;
-    QString sMessage = QString("Ri%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::RightI, value);
 }
 
 
 void
 MainWindow::onRDvalueChanged(int value) {
     RDvalue = value;
-    QString sMessage = QString("Rd%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::RightD, value);
 }
 
 
 void
 MainWindow::onRSpeedChanged(int value) {
     RSpeed = value;
-    QString sMessage = QString("Rs%1\n").arg(int(value));
-    serialPort.write(sMessage.toLatin1().constData());
+    pCommandQueue->setValue(CommandQueue::RightSpeed, value);
 }
@@ -6,15 +6,27 @@
 #include <QSerialPort>
 #include <QStatusBar>
 #include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include "serialreader.h"
+#include "latencystats.h"
 
 
 QT_FORWARD_DECLARE_CLASS(RoomWidget)
 QT_FORWARD_DECLARE_CLASS(DashboardWidget)
 QT_FORWARD_DECLARE_CLASS(Plot2D)
+QT_FORWARD_DECLARE_CLASS(MultiChannelStream)
 QT_FORWARD_DECLARE_CLASS(ControlsDialog)
+QT_FORWARD_DECLARE_CLASS(RenderScheduler)
+QT_FORWARD_DECLARE_CLASS(CommandQueue)
 QT_FORWARD_DECLARE_CLASS(QPushButton)
 QT_FORWARD_DECLARE_CLASS(QSlider)
 QT_FORWARD_DECLARE_CLASS(QLineEdit)
+QT_FORWARD_DECLARE_CLASS(QComboBox)
+QT_FORWARD_DECLARE_CLASS(QLabel)
 
 class MainWindow : public QWidget
 {
@@ -30,11 +42,20 @@ protected:
     void restoreSettings();
     void saveSettings();
     void createButtons();
+    void createLinkControls();
+    void refreshPortList();
+    void startReconnecting();
     void initLayout();
     void initPlots();
     void initControls();
-    bool serialConnect();
-    void processData(QString sData);
+    void serialConnect();
+    void processData(const TelemetryFrame& frame);
+    void flushPlotSamples();
+    bool openSession();
+    void closeSession();
+    void recordLatency(const TelemetryFrame& frame);
+    void resetLatency();
+    bool saveLatency(QString sFileName);
     void disableUI();
     void enableUI();
     void connectSignals();
@@ -42,16 +63,26 @@ protected:
 private:
 
 signals:
+    void openSerialPort(QString sPortName, int baudRate);
+    void changeBaudRate(int baudRate);
 
 private slots:
     void onTryToConnect();
+    void onPortOpened(bool bSuccess);
+    void onPortLost();
+    void onPortSelected();
+    void onBaudRateSelected();
+    void onRefreshRateSelected();
+    void onUpdateLinkMeter();
+    void onFrameRendered();
+    void onSaveLatencyPushed();
     void onConnectPushed();
     void onStartStopPushed();
     void onPIDControlsPushed();
     void onResetCameraPushed();
     void onResetCarPushed();
 
-    void onNewDataAvailable();
+    void onDrainTelemetry();
 
     void onLPvalueChanged(int value);
     void onLIvalueChanged(int value);
@@ -74,12 +105,22 @@ private:
     DashboardWidget* pDashboardWidget;
     Plot2D*          pLeftPlot;
     Plot2D*          pRightPlot;
+    MultiChannelStream* pLeftStream;  // Time, SetPt and Speed of the Left Plot
+    MultiChannelStream* pRightStream;
     QPushButton*     pButtonConnect;
     QPushButton*     pButtonStartStop;
     QPushButton*     pButtonPIDControls;
     QPushButton*     pButtonResetCamera;
     QPushButton*     pButtonResetCar;
     QLineEdit*       pEditObstacleDistance;
+    QComboBox*       pComboPort;
+    QComboBox*       pComboBaud;
+    QComboBox*       pComboRefresh;
+    RenderScheduler* pRenderScheduler;
+    CommandQueue*    pCommandQueue;
+    QLabel*          pLinkMeterLabel;
+    QLabel*          pLatencyLabel;
+    QPushButton*     pButtonSaveLatency;
     ControlsDialog*  pPIDControlsDialog;
     QStatusBar*      pStatusBar;
 
@@ -87,17 +128,35 @@ private:
     QVector3D        centerPos;
     QVector3D        upVector;
 
-    QSerialPort      serialPort;
+    QThread          readerThread;
+    SerialReader*    pSerialReader;
+    TelemetryRing*   pTelemetryRing;
     QString          serialPortName;
-    QString          receivedData;
     QQuaternion      quat0, quat1;
     QTimer           connectionTimer;
     QTimer           keepAliveTimer;
     QTimer           changeSpeedTimer;
     QTimer           steadyTimer;
     QTimer           testTimer;
+    QTimer           linkMeterTimer;
+    QElapsedTimer    linkMeterClock;
+    ClockSync        clockSync;
+    LatencyHistogram linkLatency;   // Device "T" -> host arrival
+    LatencyHistogram parseLatency;  // Arrival -> parsed
+    LatencyHistogram renderLatency; // Arrival -> repainted
+    QVector<int64_t> renderPending; // Arrivals of the frames being repainted
+    // Plot samples gathered during a drain, appended in one go
+    QVector<double>  plotTime;
+    QVector<double>  leftSpeedSamples,  leftSetPtSamples;
+    QVector<double>  rightSpeedSamples, rightSetPtSamples;
+    // The plot samples of the current run, for PlotExport
+    QFile            sessionFile;
+    QTextStream      sessionStream;
 
     int    baudRate;
+    int    reconnectDelay;
+    quint64 lastBytes;
+    quint64 lastFrames;
     float  q0, q1, q2, q3;
     double leftSpeed;
     double leftPath;
@@ -118,6 +177,7 @@ private:
     double RSpeed;
 
     double obstacleDistance;
+    bool   bObstacleDistanceChanged;
 
     bool   bConnected;
     int    iSign;
@@ -0,0 +1,101 @@
+#include "minmaxpyramid.h"
+
+#include <QtNumeric>
+
+
+MinMaxPyramid::MinMaxPyramid() {
+    clear();
+}
+
+
+void
+MinMaxPyramid::clear() {
+    for(int k=0; k<=maxLevels; k++) {
+        buckets[k].clear();
+        bHalf[k] = false;
+    }
+    nSamples = 0;
+}
+
+
+// Amortized O(1): a bucket of the level k is closed every 2^k samples
+// by merging two buckets of the level below.
+void
+MinMaxPyramid::append(double x, double y) {
+    if(qIsNaN(y))
+        return;
+    Bucket bucket = { x, float(y), float(y) };
+    nSamples++;
+    for(int k=1; k<=maxLevels; k++) {
+        if(!bHalf[k]) {
+            half[k]  = bucket;
+            bHalf[k] = true;
+            return;
+        }
+        bHalf[k] = false;
+        bucket.x    = half[k].x;
+        bucket.yMin = qMin(half[k].yMin, bucket.yMin);
+        bucket.yMax = qMax(half[k].yMax, bucket.yMax);
+        buckets[k].append(bucket);
+    }
+}
+
+
+quint64
+MinMaxPyramid::count() const {
+    return nSamples;
+}
+
+
+int
+MinMaxPyramid::levels() const {
+    int k = 0;
+    while((k < maxLevels) && !buckets[k+1].isEmpty())
+        k++;
+    return k;
+}
+
+
+const QVector<MinMaxPyramid::Bucket>&
+MinMaxPyramid::level(int k) const {
+    return buckets[k];
+}
+
+
+quint64
+MinMaxPyramid::pending(int k) const {
+    return nSamples - (quint64(buckets[k].count()) << k);
+}
+
+
+const MinMaxPyramid::Bucket*
+MinMaxPyramid::openBucket(int k) const {
+    return bHalf[k] ? &half[k] : nullptr;
+}
+
+
+int
+MinMaxPyramid::lowerBound(int k, double x) const {
+    const QVector<Bucket>& level = buckets[k];
+    int lo = 0;
+    int hi = level.count();
+    while(lo < hi) {
+        int mid = (lo+hi)/2;
+        if(level.at(mid).x < x)
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+
+int
+MinMaxPyramid::selectLevel(double xMin, double xMax, int maxBuckets) const {
+    int nLevels = levels();
+    for(int k=1; k<=nLevels; k++) {
+        if(lowerBound(k, xMax)-lowerBound(k, xMin) <= maxBuckets)
+            return k;
+    }
+    return nLevels;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QVector>
+
+
+// Unbounded history of a series kept as a min/max pyramid: the level k
+// (k >= 1) holds a bucket every 2^k samples, with the X of its first
+// sample and the extrema of the Y. All the levels together take about
+// one bucket (16 bytes) per sample.
+// The X must not decrease: the buckets are searched by bisection.
+class MinMaxPyramid
+{
+public:
+    struct Bucket {
+        double x;    // Of the first sample
+        float  yMin;
+        float  yMax;
+    };
+    static const int maxLevels = 24;
+
+    MinMaxPyramid();
+    void    clear();
+    void    append(double x, double y);
+    quint64 count() const;  // Samples appended
+    int     levels() const; // The levels holding at least a bucket
+    const QVector<Bucket>& level(int k) const;
+    // Samples not yet in a bucket of the level k (always the newest)
+    quint64 pending(int k) const;
+    // The bucket of the level k waiting for its sibling, if any: the
+    // 2^(k-1) samples just after the last bucket of the level k
+    const Bucket* openBucket(int k) const;
+    // First bucket of the level k with X not lower than x
+    int     lowerBound(int k, double x) const;
+    // The finest level with at most maxBuckets buckets in [xMin, xMax]
+    // (0 when there are no buckets at all)
+    int     selectLevel(double xMin, double xMax, int maxBuckets) const;
+
+private:
+    QVector<Bucket> buckets[maxLevels+1]; // [0] is not used
+    Bucket  half[maxLevels+1];            // Waiting for its sibling
+    bool    bHalf[maxLevels+1];
+    quint64 nSamples;
+};
@@ -0,0 +1,274 @@
+#include "multichannelstream.h"
+
+#include <QtNumeric>
+
+
+MultiChannelStream::MultiChannelStream(int nChannels, Storage storage)
+    : nChannels(qMax(nChannels, 1))
+    , bFloat(storage == Float)
+    , maxPoints(0)
+    , first(0)
+    , nPoints(0)
+    , nAdded(0)
+    , tMin(false)
+    , tMax(true)
+    , yMin(qMax(nChannels, 1), RunningExtremum(false))
+    , yMax(qMax(nChannels, 1), RunningExtremum(true))
+    , histories(qMax(nChannels, 1), nullptr)
+{
+    if(bFloat)
+        yFloat.resize(this->nChannels);
+    else
+        yData.resize(this->nChannels);
+    setMaxPoints(100);
+}
+
+
+MultiChannelStream::~MultiChannelStream() {
+    qDeleteAll(histories);
+}
+
+
+int
+MultiChannelStream::channels() const {
+    return nChannels;
+}
+
+
+bool
+MultiChannelStream::isFloat() const {
+    return bFloat;
+}
+
+
+int
+MultiChannelStream::slot(int i) const {
+    int pos = first+i;
+    return pos < maxPoints ? pos : pos-maxPoints;
+}
+
+
+int
+MultiChannelStream::count() const {
+    return nPoints;
+}
+
+
+quint64
+MultiChannelStream::added() const {
+    return nAdded;
+}
+
+
+double
+MultiChannelStream::x(int i) const {
+    return tData.at(slot(i));
+}
+
+
+double
+MultiChannelStream::y(int channel, int i) const {
+    if(bFloat)
+        return double(yFloat.at(channel).at(slot(i)));
+    return yData.at(channel).at(slot(i));
+}
+
+
+int
+MultiChannelStream::contiguous(int i, int channel, const double** ppX, const double** ppY) const {
+    int pos = slot(i);
+    *ppX = tData.constData()+pos;
+    *ppY = bFloat ? nullptr : yData.at(channel).constData()+pos;
+    return qMin(nPoints-i, maxPoints-pos);
+}
+
+
+int
+MultiChannelStream::contiguous(int i, int channel, const double** ppX, const float** ppY) const {
+    int pos = slot(i);
+    *ppX = tData.constData()+pos;
+    *ppY = bFloat ? yFloat.at(channel).constData()+pos : nullptr;
+    return qMin(nPoints-i, maxPoints-pos);
+}
+
+
+double
+MultiChannelStream::minX() const {
+    return tMin.isEmpty() ? qQNaN() : tMin.value();
+}
+
+
+double
+MultiChannelStream::maxX() const {
+    return tMax.isEmpty() ? qQNaN() : tMax.value();
+}
+
+
+double
+MultiChannelStream::minY(int channel) const {
+    return yMin.at(channel).isEmpty() ? qQNaN() : yMin.at(channel).value();
+}
+
+
+double
+MultiChannelStream::maxY(int channel) const {
+    return yMax.at(channel).isEmpty() ? qQNaN() : yMax.at(channel).value();
+}
+
+
+void
+MultiChannelStream::setHistory(int channel, bool bEnable) {
+    if(bEnable && !histories.at(channel)) {
+        histories[channel] = new MinMaxPyramid();
+    }
+    else if(!bEnable) {
+        delete histories.at(channel);
+        histories[channel] = nullptr;
+    }
+}
+
+
+// Null when the history of the channel is disabled
+const MinMaxPyramid*
+MultiChannelStream::history(int channel) const {
+    return histories.at(channel);
+}
+
+
+void
+MultiChannelStream::AddRow(double t, const double* pValues) {
+    int pos = beginRow(t);
+    for(int c=0; c<nChannels; c++)
+        storeValue(c, pos, t, pValues[c]);
+    nAdded++;
+}
+
+
+// A whole batch of rows: ppValues[c][i] is the value of the channel c
+// at the time pT[i]. Values are stored as they are, NaN included (a NaN
+// breaks the line of its channel), but they do not enter the extrema.
+void
+MultiChannelStream::AddRows(const double* pT, const double* const* ppValues, int n) {
+    for(int i=0; i<n; i++) {
+        int pos = beginRow(pT[i]);
+        for(int c=0; c<nChannels; c++)
+            storeValue(c, pos, pT[i], ppValues[c][i]);
+        nAdded++;
+    }
+}
+
+
+// O(1): the oldest row is overwritten and the extrema are
+// maintained by the running queues, with no rescan.
+int
+MultiChannelStream::beginRow(double t) {
+    if(nPoints == maxPoints) {
+        quint64 oldest = nAdded-quint64(nPoints);
+        tMin.evict(oldest);
+        tMax.evict(oldest);
+        for(int c=0; c<nChannels; c++) {
+            yMin[c].evict(oldest);
+            yMax[c].evict(oldest);
+        }
+        if(++first == maxPoints) first = 0;
+        nPoints--;
+    }
+    int pos = slot(nPoints);
+    tData[pos] = t;
+    tMin.push(nAdded, t);
+    tMax.push(nAdded, t);
+    nPoints++;
+    return pos;
+}
+
+
+void
+MultiChannelStream::storeValue(int channel, int pos, double t, double value) {
+    if(bFloat) {
+        yFloat[channel][pos] = float(value);
+        value = double(float(value)); // The extrema of what is drawn
+    }
+    else {
+        yData[channel][pos] = value;
+    }
+    if(qIsNaN(value))
+        return;
+    yMin[channel].push(nAdded, value);
+    yMax[channel].push(nAdded, value);
+    if(histories.at(channel))
+        histories.at(channel)->append(t, value);
+}
+
+
+void
+MultiChannelStream::resetRows() {
+    first   = 0;
+    nPoints = 0;
+    nAdded  = 0;
+    tMin.reset(maxPoints);
+    tMax.reset(maxPoints);
+    for(int c=0; c<nChannels; c++) {
+        yMin[c].reset(maxPoints);
+        yMax[c].reset(maxPoints);
+    }
+}
+
+
+void
+MultiChannelStream::RemoveAllPoints() {
+    resetRows();
+    for(int c=0; c<nChannels; c++) {
+        if(histories.at(c))
+            histories.at(c)->clear();
+    }
+}
+
+
+// Keeps the most recent rows that still fit (and the history)
+void
+MultiChannelStream::setMaxPoints(int nNewMax) {
+    if((nNewMax < 1) || (nNewMax == maxPoints))
+        return;
+    int nKept = qMin(nPoints, nNewMax);
+    QVector<double> newT(nNewMax);
+    for(int i=0; i<nKept; i++)
+        newT[i] = x(nPoints-nKept+i);
+    QVector<QVector<double>> newY(bFloat ? 0 : nChannels);
+    QVector<QVector<float>>  newF(bFloat ? nChannels : 0);
+    for(int c=0; c<nChannels; c++) {
+        if(bFloat) {
+            newF[c].resize(nNewMax);
+            for(int i=0; i<nKept; i++)
+                newF[c][i] = yFloat.at(c).at(slot(nPoints-nKept+i));
+        }
+        else {
+            newY[c].resize(nNewMax);
+            for(int i=0; i<nKept; i++)
+                newY[c][i] = yData.at(c).at(slot(nPoints-nKept+i));
+        }
+    }
+    maxPoints = nNewMax;
+    resetRows();
+    tData  = newT;
+    yData  = newY;
+    yFloat = newF;
+    nPoints = nKept;
+    for(int i=0; i<nKept; i++) {
+        tMin.push(nAdded, newT.at(i));
+        tMax.push(nAdded, newT.at(i));
+        for(int c=0; c<nChannels; c++) {
+            double value = bFloat ? double(newF.at(c).at(i)) : newY.at(c).at(i);
+            if(!qIsNaN(value)) {
+                yMin[c].push(nAdded, value);
+                yMax[c].push(nAdded, value);
+            }
+        }
+        nAdded++;
+    }
+}
+
+
+int
+MultiChannelStream::getMaxPoints() const {
+    return maxPoints;
+}
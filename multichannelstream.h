@@ -0,0 +1,71 @@
+#pragma once
+
+#include "datastream2d.h"
+#include "minmaxpyramid.h"
+
+#include <QVector>
+
+
+// Circular buffer of the last maxPoints rows sharing a single time
+// column, with one column per channel: the time is stored once, and
+// every column is contiguous for the draw paths.
+// The values may be stored as float to halve their size.
+// DataStream2D::setSource() makes a Data Set out of a channel.
+class MultiChannelStream
+{
+public:
+    enum Storage {
+        Double,
+        Float
+    };
+
+    MultiChannelStream(int nChannels, Storage storage=Double);
+    ~MultiChannelStream();
+    int  channels() const;
+    bool isFloat() const;
+    void setMaxPoints(int nPoints);
+    int  getMaxPoints() const;
+    // pValues holds one value per channel
+    void AddRow(double t, const double* pValues);
+    // ppValues[channel] holds the n values of the channel
+    void AddRows(const double* pT, const double* const* ppValues, int n);
+    void RemoveAllPoints();
+    // Rows are indexed from the oldest (0) to the newest (count()-1)
+    int     count() const;
+    quint64 added() const;
+    double  x(int i) const;
+    double  y(int channel, int i) const;
+    // The longest run of rows, starting from the i-th, contiguous in memory
+    int     contiguous(int i, int channel, const double** ppX, const double** ppY) const;
+    int     contiguous(int i, int channel, const double** ppX, const float** ppY) const;
+    // Extrema of the rows in the ring, NaN when none (all NaN values)
+    double  minX() const;
+    double  maxX() const;
+    double  minY(int channel) const;
+    double  maxY(int channel) const;
+    // Whole session history of a channel (the time must not decrease)
+    void    setHistory(int channel, bool bEnable);
+    const MinMaxPyramid* history(int channel) const;
+
+protected:
+    int  slot(int i) const;
+    int  beginRow(double t);
+    void storeValue(int channel, int pos, double t, double value);
+    void resetRows();
+
+private:
+    Q_DISABLE_COPY(MultiChannelStream)
+
+    int     nChannels;
+    bool    bFloat;
+    int     maxPoints;
+    int     first;
+    int     nPoints;
+    quint64 nAdded;
+    QVector<double>          tData;
+    QVector<QVector<double>> yData;   // Double storage
+    QVector<QVector<float>>  yFloat;  // Float storage
+    RunningExtremum          tMin, tMax;
+    QVector<RunningExtremum> yMin, yMax;
+    QVector<MinMaxPyramid*>  histories;
+};
@@ -18,20 +18,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "plot2d.h"
 #include "axesdialog.h"
+#include "multichannelstream.h"
+#include "plot2dgl.h"
 
 #include <float.h>
 #include <math.h>
+#include <string.h>
 #include <QSettings>
 #include <QPainter>
 #include <QCloseEvent>
 #include <QDebug>
 #include <QIcon>
+#include <QtNumeric>
 
 
 Plot2D::Plot2D(QWidget *parent, QString Title)
     : QWidget(parent)
-    , sTitle(Title)
 {
+    sTitle = Title;
     setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
     setWindowFlags(windowFlags() & ~Qt::WindowCloseButtonHint);
     setWindowFlags(windowFlags() |  Qt::WindowMinMaxButtonsHint);
@@ -45,6 +49,16 @@ Plot2D::Plot2D(QWidget *parent, QString Title)
     yMarker      = 0.0;
     bShowMarker  = false;
     bZooming     = false;
+    bStaticLayerDirty = true;
+    bBoundsDirty = true;
+    bStripChart  = false;
+    bStripFollow = true;
+    bStripDirty  = true;
+    stripSpan    = 10.0;
+    stripXMax    = 0.0;
+    stripYMin    = 0.0;
+    stripYMax    = 0.0;
+    pGLLayer     = nullptr;
 
     pPropertiesDlg = new plotPropertiesDlg(sTitle);
     connect(pPropertiesDlg, SIGNAL(configChanged()),
@@ -61,6 +75,9 @@ Plot2D::Plot2D(QWidget *parent, QString Title)
 
     setCursor(Qt::CrossCursor);
     setWindowTitle(Title);
+    // BUGGY_PLOT2D_BACKEND=opengl selects the OpenGL backend
+    if(qgetenv("BUGGY_PLOT2D_BACKEND") == "opengl")
+        SetOpenGL(true);
 }
 
 
@@ -76,6 +93,7 @@ Plot2D::~Plot2D() {
 void
 Plot2D::setTitle(QString sNewTitle) {
     sTitle = sNewTitle;
+    bStaticLayerDirty = true;
 }
 
 
@@ -97,11 +115,11 @@ Plot2D::closeEvent(QCloseEvent *event) {
 
 void
 Plot2D::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event)
     QPainter painter;
     painter.begin(this);
     painter.setFont(pPropertiesDlg->painterFont);
     QFontMetrics fontMetrics = painter.fontMetrics();
-    painter.fillRect(event->rect(), QBrush(pPropertiesDlg->painterBkColor));
     DrawPlot(&painter, fontMetrics);
     QRect textSize = fontMetrics.boundingRect(sMouseCoord);
     int nPosX = (width()/2) - (textSize.width()/2);
@@ -130,106 +148,7 @@ Plot2D::setMaxPoints(int nPoints) {
     for(int pos=0; pos<dataSetList.count(); pos++) {
         dataSetList.at(pos)->setMaxPoints(pPropertiesDlg->maxDataPoints);
     }
-}
-
-
-void
-Plot2D::SetLimits (double XMin, double XMax, double YMin, double YMax,
-                   bool AutoX, bool AutoY, bool LogX, bool LogY)
-{
-    Ax.XMin  = XMin;
-    Ax.XMax  = XMax;
-    Ax.YMin  = YMin;
-    Ax.YMax  = YMax;
-    Ax.AutoX = AutoX;
-    Ax.AutoY = AutoY;
-    Ax.LogX  = LogX;
-    Ax.LogY  = LogY;
-
-    if(!dataSetList.isEmpty()) {
-        if(AutoX | AutoY) {
-            bool EmptyData = true;
-            if(Ax.AutoX) {
-                if(Ax.LogX) {
-                    XMin = double(FLT_MAX);
-                    XMax = double(FLT_MIN);
-                } else {
-                    XMin = double(FLT_MAX);
-                    XMax =-double(FLT_MAX);
-                }
-            }
-            if(Ax.AutoY) {
-                if(Ax.LogY) {
-                    YMin = double(FLT_MAX);
-                    YMax = double(FLT_MIN);
-                } else {
-                    YMin = double(FLT_MAX);
-                    YMax =-double(FLT_MAX);
-                }
-            }
-            DataStream2D* pData;
-            for(int pos=0; pos<dataSetList.count(); pos++) {
-                pData = dataSetList.at(pos);
-                if(pData->isShown) {
-                    if(pData->m_pointArrayX.count() != 0) {
-                        EmptyData = false;
-                        if(Ax.AutoX) {
-                            if(XMin > pData->minx) {
-                                XMin = pData->minx;
-                            }
-                            if(XMax < pData->maxx) {
-                                XMax = pData->maxx;
-                            }
-                        }// if(Ax.AutoX)
-                        if(Ax.AutoY) {
-                            if(YMin > pData->miny) {
-                                YMin = pData->miny;
-                            }
-                            if(YMax < pData->maxy) {
-                                YMax = pData->maxy;
-                            }
-                        }// if(Ax.AutoY)
-                    }// if(pData->m_pointArray.GetSize() != 0)
-                }// if(pData->isShowed)
-            }// while (pos != NULL)
-            if(EmptyData) {
-                XMin = Ax.XMin;
-                XMax = Ax.XMax;
-                YMin = Ax.YMin;
-                YMax = Ax.YMax;
-            }
-        }
-    }
-    if(abs(XMin-XMax) < double(FLT_MIN)) {
-        XMin  -= 0.05*(XMax+XMin)+double(FLT_MIN);
-        XMax  += 0.05*(XMax+XMin)+double(FLT_MIN);
-    }
-    if(abs(YMin-YMax)  < double(FLT_MIN)) {
-        YMin  -= 0.05*(YMax+YMin)+double(FLT_MIN);
-        YMax  += 0.05*(YMax+YMin)+double(FLT_MIN);
-    }
-    if(XMin > XMax) {
-        double tmp = XMin;
-        XMin = XMax;
-        XMax = tmp;
-    }
-    if(YMin > YMax) {
-        double tmp = YMin;
-        YMin = YMax;
-        YMax = tmp;
-    }
-    if(LogX) {
-        if(XMin <= 0.0) XMin = double(FLT_MIN);
-        if(XMax <= 0.0) XMax = 2.0*double(FLT_MIN);
-    }
-    if(LogY) {
-        if(YMin <= 0.0) YMin = double(FLT_MIN);
-        if(YMax <= 0.0) YMax = 2.0*double(FLT_MIN);
-    }
-    Ax.XMin  = XMin;
-    Ax.XMax  = XMax;
-    Ax.YMin  = YMin;
-    Ax.YMax  = YMax;
+    bBoundsDirty = true;
 }
 
 
@@ -237,35 +156,41 @@ DataStream2D*
 Plot2D::NewDataSet(int Id, int PenWidth, QColor Color, int Symbol, QString Title) {
     DataStream2D* pDataItem = new DataStream2D(Id, PenWidth, Color, Symbol, Title);
     pDataItem->setMaxPoints(pPropertiesDlg->maxDataPoints);
+    pDataItem->setLogCache(Ax.LogX, Ax.LogY);
     dataSetList.append(pDataItem);
+    // As the former linear scan, an Id refers to its first Data Set
+    if(!dataSetIndex.contains(Id))
+        dataSetIndex.insert(Id, pDataItem);
+    bBoundsDirty = true;
+    InvalidateStripChart();
     return pDataItem;
 }
 
 
+DataStream2D*
+Plot2D::FindDataSet(int Id) const {
+    return dataSetIndex.value(Id, Q_NULLPTR);
+}
+
+
 bool
 Plot2D::ClearDataSet(int Id) {
-    bool bResult = false;
-    for(int i=0; i<dataSetList.count(); i++) {
-        DataStream2D* pDataItem = dataSetList.at(i);
-        if(pDataItem->GetId() == Id) {
-            pDataItem->RemoveAllPoints();
-            bResult = true;
-        }
-    }
-    return bResult;
+    DataStream2D* pData = FindDataSet(Id);
+    if(!pData) return false;
+    pData->RemoveAllPoints();
+    bBoundsDirty = true;
+    InvalidateStripChart();
+    return true;
 }
 
 
 void
 Plot2D::SetShowDataSet(int Id, bool Show) {
-    if(!dataSetList.isEmpty()) {
-        for(int pos=0; pos<dataSetList.count(); pos++) {
-            DataStream2D* pData = dataSetList.at(pos);
-            if(pData->GetId() == Id) {
-                pData->SetShow(Show);
-                break;
-            }
-        }
+    DataStream2D* pData = FindDataSet(Id);
+    if(pData) {
+        pData->SetShow(Show);
+        bBoundsDirty = true;
+        InvalidateStripChart();
     }
 }
 
@@ -273,389 +198,290 @@ Plot2D::SetShowDataSet(int Id, bool Show) {
 void
 Plot2D::NewPoint(int Id, double x, double y) {
     if(std::isnan(y)) return;
-    if(dataSetList.isEmpty())  return;
-    DataStream2D* pData = Q_NULLPTR;
-    for(int pos=0; pos<dataSetList.count(); pos++) {
-        if(dataSetList.at(pos)->GetId() == Id) {
-            pData = dataSetList.at(pos);
-            break;
-        }
-    }
+    DataStream2D* pData = FindDataSet(Id);
     if(pData) {
         pData->AddPoint(x, y);
+        bBoundsDirty = true;
     }
 }
 
 
+// Appends a batch of rows to a stream shared by some Data Sets of
+// this plot (see DataStream2D::setSource())
 void
-Plot2D::DrawData(QPainter* painter, QFontMetrics fontMetrics) {
-    if(dataSetList.isEmpty()) return;
-    DataStream2D* pData;
-    for(int pos=0; pos<dataSetList.count(); pos++) {
-        pData = dataSetList.at(pos);
-        if(pData->isShown) {
-            if(pData->GetProperties().Symbol == iline) {
-                LinePlot(painter, pData);
-            } else if(pData->GetProperties().Symbol == ipoint) {
-                PointPlot(painter, pData);
-            } else {
-                ScatterPlot(painter, pData);
-            }
-            if(pData->bShowCurveTitle) ShowTitle(painter, fontMetrics, pData);
-        }
-    }
+Plot2D::NewRows(MultiChannelStream* pStream, const double* t, const double* const* values, int n) {
+    if(n <= 0) return;
+    pStream->AddRows(t, values, n);
+    bBoundsDirty = true;
 }
 
 
+// Appends a whole batch to a Data Set (NaN ordinates are skipped)
 void
-Plot2D::SetShowTitle(int Id, bool show) {
-    if(dataSetList.isEmpty()) return;
-    DataStream2D* pData;
-    for(int pos=0; pos<dataSetList.count(); pos++) {
-        pData = dataSetList.at(pos);
-        if(pData->GetId() == Id) {
-            pData->SetShowTitle(show);
-            return;
-        }
+Plot2D::NewPoints(int Id, const double* x, const double* y, int n) {
+    if(n <= 0) return;
+    DataStream2D* pData = FindDataSet(Id);
+    if(pData) {
+        pData->AddPoints(x, y, n);
+        bBoundsDirty = true;
     }
 }
 
 
+// The OpenGL layer, when enabled, is laid over the plot frame.
+// Qt creates its context only when the layer is first shown: until
+// then (and after a failure) everything is drawn by QPainter.
 void
-Plot2D::ShowTitle(QPainter* painter, QFontMetrics fontMetrics, DataStream2D *pData) {
-    QPen titlePen = QPen(pData->GetProperties().Color);
-    painter->setPen(titlePen);
-    painter->drawText(int(Pf.right+4), int(Pf.top+fontMetrics.height()*(pData->GetId())), pData->GetTitle());
+Plot2D::SetOpenGL(bool bEnable) {
+    if(bEnable && !pGLLayer) {
+        pGLLayer = new Plot2DGLLayer(this);
+        connect(pGLLayer, SIGNAL(failed()),
+                this, SLOT(onGLFailed()));
+        pGLLayer->show();
+    }
+    else if(!bEnable && pGLLayer) {
+        delete pGLLayer;
+        pGLLayer = nullptr;
+    }
+    InvalidateStripChart();
+    update();
 }
 
 
 void
-Plot2D::XTicLin(QPainter* painter, QFontMetrics fontMetrics) {
-    double xmax, xmin;
-    double dx, dxx, b, fmant;
-    int isx, ic, iesp, jy, isig, ix, ix0, iy0;
-    QString Label;
-
-    if (Ax.XMax <= 0.0) {
-        xmax =-Ax.XMin;	xmin=-Ax.XMax; isx= -1;
-    } else {
-        xmax = Ax.XMax; xmin= Ax.XMin; isx= 1;
+Plot2D::onGLFailed() {
+    if(pGLLayer) {
+        pGLLayer->deleteLater();
+        pGLLayer = nullptr;
     }
-    dx = xmax - xmin;
-    b = log10(dx);
-    ic = qRound(b) - 2;
-    dx = double(qRound(pow(10.0, (b-ic-1.0))));
-
-    if(dx < 11.0) dx = 10.0;
-    else if(dx < 28.0) dx = 20.0;
-    else if(dx < 70.0) dx = 50.0;
-    else dx = 100.0;
-
-    dx = dx * pow(10.0, double(ic));
-    xfact = (Pf.right-Pf.left) / (xmax-xmin);
-    dxx = (xmax+dx) / dx;
-    dxx = floor(dxx) * dx;
-    iy0 = int(Pf.bottom + fontMetrics.height()+5);
-    iesp = int(floor(log10(dxx)));
-    if (dxx > xmax) dxx = dxx - dx;
-    do {
-        if(isx == -1)
-            ix = int(Pf.right-(dxx-xmin) * xfact);
-        else
-            ix = int((dxx-xmin) * xfact + Pf.left);
-        jy = int(Pf.bottom + 5);// Perche' 5 ?
-        painter->setPen(gridPen);
-        painter->drawLine(QLine(ix, int(Pf.top), ix, jy));
-        isig = 0;
-        if(dxx == 0.0)
-            fmant= 0.0;
-        else {
-            isig = int(dxx/fabs(dxx));
-            dxx = fabs(dxx);
-            fmant = log10(dxx) - double(iesp);
-            fmant = pow(10.0, fmant)*10000.0 + 0.5;
-            fmant = floor(fmant)/10000.0;
-            fmant = isig * fmant;
-        }
-        if(double(isx*fmant) <= -10.0)
-            Label = QString("%1").arg(double(isx*fmant), 6, 'f', 2, ' ');
-        else
-            Label = QString("%1").arg(double(isx*fmant), 6, 'f', 3, ' ');
-        ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
-        painter->setPen(labelPen);
-        painter->drawText(QPoint(ix0, iy0), Label);
-        dxx = isig*dxx - dx;
-    } while(dxx >= xmin);
-    painter->setPen(labelPen);
-    painter->drawText(QPoint(int(Pf.right + 2),	int(Pf.bottom - 0.5*fontMetrics.height())), "x10");
-    int icx = fontMetrics.horizontalAdvance("x10 ");
-    Label = QString("%1").arg(iesp, 0, 10, QLatin1Char(' '));
-    painter->setPen(labelPen);
-    painter->drawText(QPoint(int(Pf.right+icx),	int(Pf.bottom - fontMetrics.height())), Label);
+    InvalidateStripChart();
+    update();
+}
+
+
+bool
+Plot2D::IsGLReady() const {
+    return pGLLayer && pGLLayer->isReady();
+}
+
+
+// The GPU draws lines and points from the ring buffers; the symbols
+// and the history beyond the ring buffers are left to QPainter.
+bool
+Plot2D::IsDrawnByGL(DataStream2D* pData) const {
+    if(!IsGLReady())
+        return false;
+    int symbol = pData->GetProperties().Symbol;
+    if((symbol != iline) && (symbol != ipoint))
+        return false;
+    if((symbol == iline) && pData->history() && (pData->count() > 0) && (Ax.XMin < pData->x(0)))
+        return false;
+    return true;
+}
+
+
+bool
+Plot2D::IsDrawnElsewhere(DataStream2D* pData) const {
+    return IsDrawnByGL(pData);
 }
 
 
 void
-Plot2D::YTicLin(QPainter* painter, QFontMetrics fontMetrics) {
-    double ymax, ymin;
-    double dy, dyy, b, fmant;
-    int isy, icc, iesp, jx, isig, iy, ix0, iy0;
-    QString Label;
-
-    if (Ax.YMax <= 0.0) {
-        ymax = -Ax.YMin; ymin= -Ax.YMax; isy= -1;
-    } else {
-        ymax = Ax.YMax; ymin= Ax.YMin; isy= 1;
+Plot2D::UpdateGLLayer() {
+    QRect frameRect = QRectF(Pf.left, Pf.top, Pf.right-Pf.left+1.0, Pf.bottom-Pf.top+1.0).toRect();
+    if(pGLLayer->geometry() != frameRect)
+        pGLLayer->setGeometry(frameRect);
+    AxisMapping xMap = XMapping();
+    AxisMapping yMap = YMapping();
+    xMap.offset -= frameRect.left();
+    yMap.offset -= frameRect.top();
+    pGLLayer->setMappings(xMap, yMap);
+    QList<DataStream2D*> glSeries;
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        DataStream2D* pData = dataSetList.at(pos);
+        if(pData->isShown && IsDrawnByGL(pData))
+            glSeries.append(pData);
     }
-    dy = ymax - ymin;
-    b = log10(dy);
-    icc = qRound(b) - 2;
-    dy = double(qRound(pow(10.0, (b-icc-1.0))));
-
-    if(dy < 11.0) dy = 10.0;
-    else if(dy < 28.0) dy = 20.0;
-    else if(dy < 70.0) dy = 50.0;
-    else dy = 100.0;
-
-    dy = dy * pow(10.0, double(icc));
-    yfact = (Pf.top-Pf.bottom) / (ymax-ymin);
-    dyy = (ymax+dy) / dy;
-    dyy = floor(dyy) * dy;
-    iesp = int(floor(log10(dyy)));
-    if(dyy > ymax) dyy = dyy - dy;
-    do {
-        if(isy == -1)
-            iy = int(Pf.top - (dyy-ymin) * yfact);
-        else
-            iy = int((dyy-ymin) * yfact + Pf.bottom);
-        jx = int(Pf.right);
-        painter->setPen(gridPen);
-        painter->drawLine(QLine(int(Pf.left-5), iy, jx, iy));
-        isig = 0;
-        if(dyy == 0.0)
-            fmant = 0.0;
-        else{
-            isig = int(dyy/fabs(dyy));
-            dyy = fabs(dyy);
-            fmant = log10(dyy) - double(iesp);
-            fmant = pow(10.0, fmant)*10000.0 + 0.5;
-            fmant = floor(fmant)/10000.0;
-            fmant = isig * fmant;
-        }
-        if(double(isy*fmant) <= -10.0)
-            Label = QString("%1").arg(double(isy*fmant), 7, 'f', 3, ' ');
-        else
-            Label = QString("%1").arg(double(isy*fmant), 7, 'f', 4, ' ');
-        ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
-        iy0 = iy + fontMetrics.height()/2;
-        painter->setPen(labelPen);
-        painter->drawText(QPoint(ix0, iy0), Label);
-        dyy = isig*dyy - dy;
-    }	while (dyy >= ymin);
-    QPoint point(int(Pf.left), int(Pf.top-0.5*fontMetrics.height()));
-    painter->setPen(labelPen);
-    painter->drawText(point, "x10");
-    int icx = fontMetrics.horizontalAdvance("x10 ");
-    Label = QString("%1").arg(iesp, 0, 10, QLatin1Char(' '));
-    painter->setPen(labelPen);
-    painter->drawText(QPoint(int(int(Pf.left)+icx),int(Pf.top-fontMetrics.height())),Label);
+    pGLLayer->setSeries(glSeries);
+    pGLLayer->update();
 }
 
 
 void
-Plot2D::XTicLog(QPainter* painter, QFontMetrics fontMetrics) {
-    int i, ix, ix0, iy0, jy, j;
-    double dx;
-    QString Label;
-
-    jy = int(Pf.bottom + 5);// Perche' 5 ?
-    iy0 = int(Pf.bottom + fontMetrics.height()+5);
-
-    if(Ax.XMin < double(FLT_MIN)) Ax.XMin = double(FLT_MIN);
-    if(Ax.XMax < double(FLT_MIN)) Ax.XMax = 10.0*double(FLT_MIN);
-
-    double xlmin = log10(Ax.XMin);
-    int minx = int(xlmin);
-    if((xlmin < 0.0) && fabs(xlmin-minx) <= double(FLT_MIN)) minx= minx - 1;
-
-    double xlmax = log10(Ax.XMax);
-    int maxx = int(xlmax);
-    if((xlmax > 0.0) && fabs(xlmax-maxx) <= double(FLT_MIN)) maxx= maxx + 1;
-
-    xfact = (Pf.right-Pf.left) / ((xlmax-xlmin)+double(FLT_MIN));
-
-    bool init = true;
-    int decades = maxx - minx;
-    double x = pow(10.0, minx);
-    if(decades < 6) {
-        for(i=0; i<decades; i++) {
-            dx = pow(10.0, (minx + i));
-            if(x >= Ax.XMin) {
-                ix = int(Pf.left + (log10(x)-xlmin)*xfact);
-                Label = QString("%1").arg(x, 7, 'e', 0, ' ');
-                ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
-                painter->setPen(labelPen);
-                painter->drawText(QPoint(ix0, iy0), Label);
-                init = false;
-            }
-            for(j=1; j<10; j++){
-                x = x + dx;
-                if((x >= Ax.XMin) && (x <= Ax.XMax)) {
-                    ix = int(Pf.left + (log10(x)-xlmin)*xfact);
-                    painter->setPen(gridPen);
-                    painter->drawLine(QLine(ix, int(Pf.top), ix, jy));
-                    Label = QString("%1").arg(x, 7, 'e', 0, ' ');
-                    if(init || (j == 9 && decades == 1)) {
-                        ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
-                        painter->setPen(labelPen);
-                        painter->drawText(QPoint(ix0, iy0), Label);
-                        init = false;
-                    } else if (decades == 1) {
-                        Label = Label.left(2);
-                        ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
-                        painter->setPen(labelPen);
-                        painter->drawText(QPoint(ix0, iy0), Label);
-                    }
-                }
-            }
-        }// for(i=0; i<decades; i++)
-        if((decades != 1) && (x <= Ax.XMax)) {
-            Label = QString("%1").arg(x, 7, 'e', 0, ' ');
-            ix = int(Pf.left + (log10(x)-xlmin)*xfact);
-            ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
-            painter->setPen(labelPen);
-            painter->drawText(QPoint(ix0, iy0), Label);
-        }
-    } else {// decades > 5
-        for(i=1; i<=decades; i++) {
-            x = pow(10.0, minx + i);
-            if((x >= Ax.XMin) && (x <= Ax.XMax)) {
-                ix = int(Pf.left + (log10(x)-xlmin)*xfact);
-                painter->setPen(gridPen);
-                painter->drawLine(QLine(ix, int(Pf.top),ix, jy));
-                Label = QString("%1").arg(x, 7, 'e', 0, ' ');
-                ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
-                painter->setPen(labelPen);
-                painter->drawText(QPoint(ix0, iy0), Label);
-            }
-        }
-    }//if(decades < 6)
+Plot2D::SetShowTitle(int Id, bool show) {
+    DataStream2D* pData = FindDataSet(Id);
+    if(pData) {
+        pData->SetShowTitle(show);
+    }
 }
 
 
 void
-Plot2D::YTicLog(QPainter* painter, QFontMetrics fontMetrics) {
-    int i, iy, ix0, iy0, j;
-    double dy;
-    QString Label;
-
-    if(Ax.YMin < double(FLT_MIN)) Ax.YMin = double(FLT_MIN);
-    if(Ax.YMax < double(FLT_MIN)) Ax.YMax = 10.0*double(FLT_MIN);
-
-    double ylmin = log10(Ax.YMin);
-    int miny = int(ylmin);
-    if((ylmin < 0.0) && fabs(ylmin-miny) <= double(FLT_MIN)) miny= miny - 1;
-
-    double ylmax = log10(Ax.YMax);
-    int maxy = int(ylmax);
-    if((ylmax > 0.0) && fabs(ylmax-maxy) <= double(FLT_MIN)) maxy= maxy + 1;
-
-    yfact = (Pf.top-Pf.bottom) / ((ylmax-ylmin)+double(FLT_MIN));
-
-    bool init = true;
-    int decades = maxy - miny;
-    double y = pow(10.0, miny);
-    if(decades < 6) {
-        for(i=0; i<decades; i++) {
-            dy = pow(10.0, (miny + i));
-            if(y >= Ax.YMin) {
-                iy = int(Pf.bottom + (log10(y)-ylmin)*yfact);
-                Label = QString("%1").arg(y, 7, 'e', 0, ' ');
-                ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
-                iy0 = iy + fontMetrics.height()/2;
-                painter->setPen(labelPen);
-                painter->drawText(QPoint(ix0, iy0), Label);
-                init = false;
-            }
-            for(j=1; j<10; j++){
-                y = y + dy;
-                if((y >= Ax.YMin) && (y <= Ax.YMax)) {
-                    iy = int(Pf.bottom + (log10(y)-ylmin)*yfact);
-                    painter->setPen(gridPen);
-                    painter->drawLine(QLine(int(Pf.left-5), iy, int(Pf.right), iy));
-                    Label = QString("%1").arg(y, 7, 'e', 0, ' ');
-                    if(init || (j == 9 && decades == 1)) {
-                        ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
-                        iy0 = iy + fontMetrics.height()/2;
-                        painter->setPen(labelPen);
-                        painter->drawText(QPoint(ix0, iy0), Label);
-                        init = false;
-                    } else if (decades == 1) {
-                        Label = Label.left(2);
-                        ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
-                        iy0 = iy + fontMetrics.height()/2;
-                        painter->setPen(labelPen);
-                        painter->drawText(QPoint(ix0, iy0), Label);
-                    }
-                }
-            }
-        }// for(i=0; i<decades; i++)
-        if((decades != 1) && (y <= Ax.YMax)) {
-            Label = QString("%1").arg(y, 7, 'e', 0, ' ');
-            iy = int(Pf.bottom - (log10(y)-ylmin)*yfact);
-            ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
-            iy0 = iy + fontMetrics.height()/2;
-            painter->setPen(labelPen);
-            painter->drawText(QPoint(ix0, iy0), Label);
-        }
-    } else {// decades > 5
-        for(i=1; i<=decades; i++) {
-            y = pow(10.0, miny + i);
-            if((y >= Ax.YMin) && (y <= Ax.YMax)) {
-                iy = int(Pf.bottom + (log10(y)-ylmin)*yfact);
-                painter->setPen(gridPen);
-                painter->drawLine(QLine(int(Pf.left-5), iy, int(Pf.right), iy));
-                Label = QString("%1").arg(y, 7, 'e', 0, ' ');
-                ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
-                iy0 = iy + fontMetrics.height()/2;
-                painter->setPen(labelPen);
-                painter->drawText(QPoint(ix0, iy0), Label);
-            }
+Plot2D::DrawPlot(QPainter* painter, QFontMetrics fontMetrics) {
+    bool bGL = IsGLReady();
+    if(IsScrolling()) {
+        if(!bGL) {
+            DrawStripChart(painter, fontMetrics);
+            return;
         }
-    }//if(decades < 6)
+        // The GPU redraws everything: no image to scroll
+        double newest = NewestX();
+        if(newest != -DBL_MAX)
+            Ax.XMax = newest;
+        Ax.XMin = Ax.XMax - stripSpan;
+        if(Ax.AutoY)
+            AutoScaleStripY(Ax.XMin);
+    }
+    else if(Ax.AutoX || Ax.AutoY) {
+        AutoScale();
+    }
+
+    SetFrame(size(), fontMetrics);
+
+    // Background, frame, grid, ticks and labels change only with
+    // the limits, the size or the plot properties
+    if(!IsStaticLayerValid())
+        RenderStaticLayer(fontMetrics);
+    painter->drawPixmap(0, 0, staticLayer);
+    if(IsScrolling())
+        XTicLin(painter, fontMetrics);
+    DrawData(painter, fontMetrics);
+    if(pGLLayer)
+        UpdateGLLayer();
+    if(bZooming) {
+        QPen zoomPen(Qt::yellow);
+        painter->setPen(zoomPen);
+        int ix0 = zoomStart.rx() < zoomEnd.rx() ? zoomStart.rx() : zoomEnd.rx();
+        int iy0 = zoomStart.ry() < zoomEnd.ry() ? zoomStart.ry() : zoomEnd.ry();
+        painter->drawRect(ix0, iy0, abs(zoomStart.rx()-zoomEnd.rx()), abs(zoomStart.ry()-zoomEnd.ry()));
+    }
 }
 
 
 void
-Plot2D::DrawFrame(QPainter* painter, QFontMetrics fontMetrics) {
-    if(Ax.LogX) XTicLog(painter, fontMetrics); else XTicLin(painter, fontMetrics);
-    if(Ax.LogY) YTicLog(painter, fontMetrics); else YTicLin(painter, fontMetrics);
-
-    painter->setPen(framePen);
-    painter->drawLine(QLine(int(Pf.left), int(Pf.bottom), int(Pf.right), int(Pf.bottom)));
-    painter->drawLine(QLine(int(Pf.right), int(Pf.bottom), int(Pf.right), int(Pf.top)));
-    painter->drawLine(QLine(int(Pf.right), int(Pf.top), int(Pf.left), int(Pf.top)));
-    painter->drawLine(QLine(int(Pf.left), int(Pf.top), int(Pf.left), int(Pf.bottom)));
-
-    painter->setPen(labelPen);
-    int icx = fontMetrics.horizontalAdvance((sTitle));
-    painter->drawText(QPoint(int((width()-icx)/2), int(fontMetrics.height())), sTitle);
+Plot2D::SetStripChart(bool bEnable, double xSpan) {
+    bStripChart = bEnable;
+    bStripFollow = true;
+    if(xSpan > 0.0)
+        stripSpan = xSpan;
+    Ax.AutoX = false;
+    Ax.LogX  = false;
+    SyncLogCache();
+    InvalidateStripChart();
+    bStaticLayerDirty = true;
+    update();
+}
+
+
+// A strip chart scrolls while it follows the newest sample. Panning
+// back in time freezes it; it resumes when panned up to the present.
+bool
+Plot2D::IsScrolling() const {
+    return bStripChart && bStripFollow;
 }
 
 
 void
-Plot2D::DrawPlot(QPainter* painter, QFontMetrics fontMetrics) {
-    if(Ax.AutoX || Ax.AutoY) {
-        SetLimits (Ax.XMin, Ax.XMax, Ax.YMin, Ax.YMax, Ax.AutoX, Ax.AutoY, Ax.LogX, Ax.LogY);
+Plot2D::SetStripFollow(bool bFollow) {
+    if(bFollow == bStripFollow)
+        return;
+    bStripFollow = bFollow;
+    bStaticLayerDirty = true;
+    InvalidateStripChart();
+}
+
+
+void
+Plot2D::InvalidateStripChart() {
+    bStripDirty = true;
+}
+
+
+// The data layer covers the plot frame. When nothing but new samples
+// arrived it is scrolled left by the elapsed (whole, device) pixels and only the
+// segments after the last drawn sample are added. Everything is redrawn
+// on a zoom, a pan, a change of the Y limits or of the series.
+void
+Plot2D::DrawStripChart(QPainter* painter, QFontMetrics fontMetrics) {
+    SetFrame(size(), fontMetrics);
+
+    bool bFull = bStripDirty;
+    double newest = NewestX();
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        DataStream2D* pData = dataSetList.at(pos);
+        if(pData->added() < stripDrawn.value(pData, 0))
+            bFull = true; // Cleared meanwhile
+    }
+    if(newest == -DBL_MAX)
+        newest = stripXMax;
+    if(Ax.AutoY)
+        AutoScaleStripY(newest-stripSpan);
+
+    qreal ratio = devicePixelRatioF();
+    QSize layerSize = QSize(int(Pf.right-Pf.left)+1, int(Pf.bottom-Pf.top)+1);
+    if(dataLayer.size() != layerSize*ratio) {
+        dataLayer = QImage(layerSize*ratio, QImage::Format_ARGB32_Premultiplied);
+        bFull = true;
+    }
+    dataLayer.setDevicePixelRatio(ratio);
+    if((Ax.YMin != stripYMin) || (Ax.YMax != stripYMax))
+        bFull = true;
+
+    xfact = (Pf.right-Pf.left) / stripSpan;
+    // Advance by whole device pixels only, so that the scroll is exact
+    // also with a fractional device pixel ratio
+    double deviceFact = xfact*ratio;
+    int nPixels = 0;
+    if(!bFull) {
+        nPixels = int(floor((newest-stripXMax)*deviceFact));
+        if((nPixels < 0) || (nPixels >= dataLayer.width()))
+            bFull = true;
+    }
+    if(bFull) {
+        Ax.XMax = newest;
+    }
+    else {
+        Ax.XMax = stripXMax + nPixels/deviceFact;
     }
+    Ax.XMin = Ax.XMax - stripSpan;
 
-    Pf.left = fontMetrics.horizontalAdvance("-0.00000") + 2.0;
-    Pf.right = width() - fontMetrics.horizontalAdvance("x10-999") - 5.0;
-    Pf.top = 2.0 * fontMetrics.height();
-    Pf.bottom = height() - 3.0*fontMetrics.height();
+    if(!IsStaticLayerValid())
+        RenderStaticLayer(fontMetrics);
+    painter->drawPixmap(0, 0, staticLayer);
+    XTicLin(painter, fontMetrics);
 
-    DrawFrame(painter, fontMetrics);
-    DrawData(painter, fontMetrics);
+    if(bFull) {
+        dataLayer.fill(Qt::transparent);
+        stripDrawn.clear();
+    }
+    else if(nPixels > 0) {
+        ScrollDataLayer(nPixels);
+    }
+    QPainter layerPainter(&dataLayer);
+    layerPainter.translate(-Pf.left, -Pf.top);
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        DataStream2D* pData = dataSetList.at(pos);
+        if(!pData->isShown)
+            continue;
+        // Restart from the last sample drawn, to join the new segments
+        quint64 nNew = pData->added() - stripDrawn.value(pData, 0);
+        int iFirst = qMax(0, pData->count()-int(qMin(nNew, quint64(pData->count())))-1);
+        if(nNew > 0)
+            DrawSeries(&layerPainter, pData, iFirst);
+        stripDrawn.insert(pData, pData->added());
+    }
+    layerPainter.end();
+    painter->drawImage(QPointF(Pf.left, Pf.top), dataLayer);
+    stripXMax = Ax.XMax;
+    stripYMin = Ax.YMin;
+    stripYMax = Ax.YMax;
+    bStripDirty = false;
+
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        DataStream2D* pData = dataSetList.at(pos);
+        if(pData->isShown && pData->bShowCurveTitle)
+            ShowTitle(painter, fontMetrics, pData);
+    }
     if(bZooming) {
         QPen zoomPen(Qt::yellow);
         painter->setPen(zoomPen);
@@ -666,216 +492,97 @@ Plot2D::DrawPlot(QPainter* painter, QFontMetrics fontMetrics) {
 }
 
 
+// The ring may hold much more than the strip span: the Y limits fit
+// only the samples from xMin on (and the one just before, which the
+// line starts from). The windows are kept as running extrema: each
+// paint pushes the samples arrived meanwhile and evicts those scrolled
+// out, so that nothing is rescanned.
 void
-Plot2D::LinePlot(QPainter* painter, DataStream2D* pData) {
-    if(!pData->isShown) return;
-    int iMax = int(pData->m_pointArrayX.count());
-    if(iMax == 0) return;
-    QPen dataPen = QPen(pData->GetProperties().Color);
-    dataPen.setWidth(pData->GetProperties().PenWidth);
-    painter->setPen(dataPen);
-    int ix0, iy0, ix1, iy1;
-    double xlmin, ylmin;
-    if(Ax.XMin > 0.0)
-        xlmin = log10(Ax.XMin);
-    else
-        xlmin = double(FLT_MIN);
-    if(Ax.YMin > 0.0)
-        ylmin = log10(Ax.YMin);
-    else ylmin = double(FLT_MIN);
-
-    if(Ax.LogX) {
-        if(pData->m_pointArrayX[0] > 0.0)
-            ix0 = int((Pf.left + (log10(pData->m_pointArrayX[0]) - xlmin)*xfact));
-        else
-            ix0 =-INT_MAX; // Solo per escludere il punto
-    } else
-        ix0 = int((Pf.left + (pData->m_pointArrayX[0] - Ax.XMin)*xfact));
-
-    if(Ax.LogY) {
-        if(pData->m_pointArrayY[0] > 0.0)
-            iy0 = int((Pf.bottom + (log10(pData->m_pointArrayY[0]) - ylmin)*yfact));
-        else
-            iy0 =-INT_MAX; // Solo per escludere il punto
-    } else
-        iy0 = int((Pf.bottom + (pData->m_pointArrayY[0] - Ax.YMin)*yfact));
-
-    for(int i=1; i<iMax; i++) {
-        if(Ax.LogX)
-            ix1 = int(((log10(pData->m_pointArrayX[i]) - xlmin)*xfact) + Pf.left);
-        else
-            ix1 = int(((pData->m_pointArrayX[i] - Ax.XMin)*xfact) + Pf.left);
-        if(Ax.LogY)
-            if(pData->m_pointArrayY[i] > 0.0)
-                iy1 = int((Pf.bottom + (log10(pData->m_pointArrayY[i]) - ylmin)*yfact));
-            else
-                iy1 =-INT_MAX; // Solo per escludere il punto
-        else
-            iy1 = int((Pf.bottom + (pData->m_pointArrayY[i] - Ax.YMin)*yfact));
-
-        if(!(ix1<Pf.left || iy1<Pf.top || iy1>Pf.bottom)) {
-            painter->drawLine(ix0, iy0, ix1, iy1);
+Plot2D::AutoScaleStripY(double xMin) {
+    double ymin = DBL_MAX, ymax = -DBL_MAX;
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        DataStream2D* pData = dataSetList.at(pos);
+        if(!pData->isShown || (pData->count() == 0))
+            continue;
+        StripWindow& window = stripWindows[pData];
+        quint64 added  = pData->added();
+        quint64 oldest = added-quint64(pData->count());
+        bool bWidened = (window.start > oldest) && (window.start < added) &&
+                        (pData->x(int(window.start-oldest)) >= xMin);
+        if((window.capacity != pData->getMaxPoints()) || (window.bLog != Ax.LogY) ||
+           (added < window.next) || bWidened) {
+            window.capacity = pData->getMaxPoints();
+            window.bLog = Ax.LogY;
+            window.yLow.reset(window.capacity);
+            window.yHigh.reset(window.capacity);
+            window.start = window.next = oldest;
         }
-        ix0 = ix1;
-        iy0 = iy1;
-        if(ix1 > Pf.right) {
-            break;
+        // The samples overwritten in the ring go first: the queues never
+        // hold more than the ring
+        window.start = qMax(window.start, oldest);
+        window.next  = qMax(window.next, oldest);
+        window.yLow.evictBefore(window.start);
+        window.yHigh.evictBefore(window.start);
+        for(; window.next<added; window.next++) {
+            double y = pData->y(int(window.next-oldest));
+            if(qIsNaN(y) || (Ax.LogY && (y <= 0.0)))
+                continue;
+            window.yLow.push(window.next, y);
+            window.yHigh.push(window.next, y);
         }
-    }
-    DrawLastPoint(painter, pData);
+        while((window.start+1 < added) && (pData->x(int(window.start+1-oldest)) < xMin))
+            window.start++;
+        window.yLow.evictBefore(window.start);
+        window.yHigh.evictBefore(window.start);
+        if(window.yLow.isEmpty())
+            continue;
+        ymin = qMin(ymin, window.yLow.value());
+        ymax = qMax(ymax, window.yHigh.value());
+    }
+    if(ymin > ymax)
+        return;
+    AutoRange(ymin, ymax, Ax.LogY, &Ax.YMin, &Ax.YMax);
 }
 
 
 void
-Plot2D::DrawLastPoint(QPainter* painter, DataStream2D* pData) {
-    if(!pData->isShown) return;
-    int ix, iy, i;
-    i = int(pData->m_pointArrayX.count()-1);
-
-    double xlmin, ylmin;
-    if(Ax.XMin > 0.0)
-        xlmin = log10(Ax.XMin);
-    else
-        xlmin = double(FLT_MIN);
-    if(Ax.YMin > 0.0)
-        ylmin = log10(Ax.YMin);
-    else ylmin = double(FLT_MIN);
-
-    if(Ax.LogX) {
-        if(pData->m_pointArrayX[i] > 0.0)
-            ix = int(((log10(pData->m_pointArrayX[i]) - xlmin)*xfact) + Pf.left);
-        else
-            return;
-    } else {
-        ix = int(((pData->m_pointArrayX[i] - Ax.XMin)*xfact) + Pf.left);
+Plot2D::ScrollDataLayer(int nPixels) {
+    int width = dataLayer.width();
+    if(nPixels >= width) {
+        dataLayer.fill(Qt::transparent);
+        return;
     }
-    if(Ax.LogY) {
-        if(pData->m_pointArrayY[i] > 0.0)
-            iy = int((Pf.bottom + (log10(pData->m_pointArrayY[i]) - ylmin)*yfact));
-        else
-            return;
+    for(int row=0; row<dataLayer.height(); row++) {
+        quint32* pRow = reinterpret_cast<quint32*>(dataLayer.scanLine(row));
+        memmove(pRow, pRow+nPixels, size_t(width-nPixels)*sizeof(quint32));
+        memset(pRow+width-nPixels, 0, size_t(nPixels)*sizeof(quint32));
     }
-    else {
-        iy = int((Pf.bottom + (pData->m_pointArrayY[i] - Ax.YMin)*yfact));
-    }
-    if(ix<=Pf.right && ix>=Pf.left && iy>=Pf.top && iy<=Pf.bottom)
-        painter->drawPoint(ix, iy);
-    return;
 }
 
 
-void
-Plot2D::PointPlot(QPainter* painter, DataStream2D* pData) {
-    int iMax = int(pData->m_pointArrayX.count());
-    if(iMax == 0) return;
-    QPen dataPen = QPen(pData->GetProperties().Color);
-    dataPen.setWidth(pData->GetProperties().PenWidth);
-    painter->setPen(dataPen);
-    int ix, iy;
-    double xlmin, ylmin;
-    if(Ax.XMin > 0.0)
-        xlmin = log10(Ax.XMin);
-    else
-        xlmin = double(FLT_MIN);
-    if(Ax.YMin > 0.0)
-        ylmin = log10(Ax.YMin);
-    else ylmin = double(FLT_MIN);
-
-    for (int i=0; i < iMax; i++) {
-        if(!(pData->m_pointArrayX[i] < Ax.XMin ||
-             pData->m_pointArrayX[i] > Ax.XMax ||
-             pData->m_pointArrayY[i] < Ax.YMin ||
-             pData->m_pointArrayY[i] > Ax.YMax ))
-        {
-            if(Ax.LogX) {
-                if(pData->m_pointArrayX[i] > 0.0)
-                    ix = int(((log10(pData->m_pointArrayX[i]) - xlmin)*xfact) + Pf.left);
-                else
-                    ix = -INT_MAX;
-            } else
-                ix = int(((pData->m_pointArrayX[i] - Ax.XMin)*xfact) + Pf.left);
-            if(Ax.LogY) {
-                if(pData->m_pointArrayY[i] > 0.0)
-                    iy = int((Pf.bottom + (log10(pData->m_pointArrayY[i]) - ylmin)*yfact));
-                else
-                    iy =-INT_MAX; // Solo per escludere il punto
-            } else
-                iy = int((Pf.bottom + (pData->m_pointArrayY[i] - Ax.YMin)*yfact));
-            painter->drawPoint(ix, iy);
-        }
-    }//for (int i=0; i <= iMax; i++)
+bool
+Plot2D::IsStaticLayerValid() const {
+    return !bStaticLayerDirty &&
+           (staticLayer.size() == size()*devicePixelRatioF()) &&
+           (staticLayer.devicePixelRatioF() == devicePixelRatioF()) &&
+           (IsScrolling() || ((cachedAx.XMin == Ax.XMin) && (cachedAx.XMax == Ax.XMax))) &&
+           (cachedAx.YMin == Ax.YMin) && (cachedAx.YMax == Ax.YMax) &&
+           (cachedAx.LogX == Ax.LogX) && (cachedAx.LogY == Ax.LogY);
 }
 
 
 void
-Plot2D::ScatterPlot(QPainter* painter, DataStream2D* pData) {
-    int iMax = int(pData->m_pointArrayX.count());
-    if(iMax == 0) return;
-    QPen dataPen = QPen(pData->GetProperties().Color);
-    dataPen.setWidth(pData->GetProperties().PenWidth);
-    painter->setPen(dataPen);
-    int ix, iy;
-
-    double xlmin, ylmin;
-    if(Ax.XMin > 0.0)
-        xlmin = log10(Ax.XMin);
-    else
-        xlmin = double(FLT_MIN);
-    if(Ax.YMin > 0.0)
-        ylmin = log10(Ax.YMin);
-    else ylmin = double(FLT_MIN);
-
-    int SYMBOLS_DIM = 8;
-    QSize Size(SYMBOLS_DIM, SYMBOLS_DIM);
-
-    for (int i=0; i < iMax; i++) {
-        if(pData->m_pointArrayX[i] >= Ax.XMin &&
-           pData->m_pointArrayX[i] <= Ax.XMax &&
-           pData->m_pointArrayY[i] >= Ax.YMin &&
-           pData->m_pointArrayY[i] <= Ax.YMax)
-        {
-            if(Ax.LogX)
-                if(pData->m_pointArrayX[i] > 0.0)
-                    ix = int(((log10(pData->m_pointArrayX[i]) - xlmin)*xfact) + Pf.left);
-                else
-                    ix = -INT_MAX;
-            else//Asse X Lineare
-                ix= int(((pData->m_pointArrayX[i] - Ax.XMin)*xfact) + Pf.left);
-            if(Ax.LogY) {
-                if(pData->m_pointArrayY[i] > 0.0)
-                    iy = int(((log10(pData->m_pointArrayY[i]) - ylmin)*yfact) + Pf.bottom);
-                else
-                    iy =-INT_MAX; // Solo per escludere il punto
-            } else
-                iy = int(((pData->m_pointArrayY[i] - Ax.YMin)*yfact) + Pf.bottom);
-
-            if(pData->GetProperties().Symbol == iplus) {
-                painter->drawLine(ix, iy-Size.height()/2, ix, iy+Size.height()/2+1);
-                painter->drawLine(ix-Size.width()/2, iy, ix+Size.width()/2+1, iy);
-            } else if(pData->GetProperties().Symbol == iper) {
-                painter->drawLine(ix-Size.width()/2+1, iy+Size.height()/2-1, ix+Size.width()/2-1, iy-Size.height()/2);
-                painter->drawLine(ix+Size.width()/2-1, iy+Size.height()/2-1, ix-Size.width()/2+1, iy-Size.height()/2);
-            } else if(pData->GetProperties().Symbol == istar) {
-                painter->drawLine(ix, iy-Size.height()/2, ix, iy+Size.height()/2+1);
-                painter->drawLine(ix-Size.width()/2, iy, ix+Size.width()/2+1, iy);
-                painter->drawLine(ix-Size.width()/2+1, iy+Size.height()/2-1, ix+Size.width()/2-1, iy-Size.height()/2);
-                painter->drawLine(ix+Size.width()/2-1, iy+Size.height()/2-1, ix-Size.width()/2+1, iy-Size.height()/2);
-            } else if(pData->GetProperties().Symbol == iuptriangle) {
-                painter->drawLine(ix, iy-Size.height()/2, ix+Size.width()/2, iy+Size.height()/2);
-                painter->drawLine(ix+Size.width()/2, iy+Size.height()/2, ix-Size.width()/2, iy+Size.height()/2);
-                painter->drawLine(ix-Size.width()/2, iy+Size.height()/2, ix, iy-Size.height()/2);
-            } else if(pData->GetProperties().Symbol == idntriangle) {
-                painter->drawLine(ix, iy+Size.height()/2, ix+Size.width()/2, iy-Size.height()/2);
-                painter->drawLine(ix+Size.width()/2, iy-Size.height()/2, ix-Size.width()/2, iy-Size.height()/2);
-                painter->drawLine(ix-Size.width()/2, iy-Size.height()/2, ix, iy+Size.height()/2);
-            } else if(pData->GetProperties().Symbol == icircle) {
-                painter->drawEllipse(QRect(ix-Size.width()/2, iy-Size.height()/2, Size.width(), Size.height()));
-            } else {
-                painter->drawLine(ix-Size.width()/2, iy, ix-Size.width()/2, iy-Size.height());
-                painter->drawLine(ix, iy-Size.height()/2, ix-Size.width(), iy-Size.height()/2);
-            }
-        }
-    }
+Plot2D::RenderStaticLayer(QFontMetrics fontMetrics) {
+    qreal ratio = devicePixelRatioF();
+    if(staticLayer.size() != size()*ratio)
+        staticLayer = QPixmap(size()*ratio);
+    staticLayer.setDevicePixelRatio(ratio);
+    staticLayer.fill(pPropertiesDlg->painterBkColor);
+    QPainter painter(&staticLayer);
+    painter.setFont(pPropertiesDlg->painterFont);
+    DrawFrame(&painter, fontMetrics); // Sets xfact and yfact too
+    cachedAx = Ax;
+    bStaticLayerDirty = false;
 }
 
 
@@ -908,20 +615,12 @@ Plot2D::mouseReleaseEvent(QMouseEvent *event) {
             QPoint distance = zoomStart-zoomEnd;
             if(abs(distance.rx()) < 10 || abs(distance.ry()) < 10) return;
             double x1, x2, y1, y2, tmp;
-            if(Ax.LogX) {
-                x1 = pow(10.0, log10(Ax.XMin)+(zoomEnd.rx()-Pf.left)/xfact);
-                x2 = pow(10.0, log10(Ax.XMin)+(zoomStart.rx()-Pf.left)/xfact);
-            } else {
-                x1 = (zoomEnd.rx()-Pf.left)/xfact + Ax.XMin;
-                x2 = (zoomStart.rx()-Pf.left)/xfact + Ax.XMin;
-            }
-            if(Ax.LogY) {
-                y1 = pow(10.0, log10(Ax.YMin)+(zoomEnd.ry()-Pf.bottom)/yfact);
-                y2 = pow(10.0, log10(Ax.YMin)+(zoomStart.ry()-Pf.bottom)/yfact);
-            } else {
-                y1 = (zoomEnd.ry()-Pf.bottom) / yfact + Ax.YMin;
-                y2 = (zoomStart.ry()-Pf.bottom) / yfact + Ax.YMin;
-            }
+            AxisMapping xMap = XMapping();
+            AxisMapping yMap = YMapping();
+            x1 = ScreenTransform::toWorld(zoomEnd.rx(),   xMap);
+            x2 = ScreenTransform::toWorld(zoomStart.rx(), xMap);
+            y1 = ScreenTransform::toWorld(zoomEnd.ry(),   yMap);
+            y2 = ScreenTransform::toWorld(zoomStart.ry(), yMap);
             if(x2<x1) {
                 tmp = x2;
                 x2 = x1;
@@ -933,6 +632,9 @@ Plot2D::mouseReleaseEvent(QMouseEvent *event) {
                 y1 = tmp;
             }
             SetLimits(x1, x2, y1, y2, Ax.AutoX, Ax.AutoY, Ax.LogX, Ax.LogY);
+            if(bStripChart)
+                stripSpan = Ax.XMax-Ax.XMin;
+            InvalidateStripChart();
         }
         event->accept();
     }
@@ -966,6 +668,9 @@ Plot2D::mouseMoveEvent(QMouseEvent *event) {
             }
             lastPos = event->pos();
             SetLimits (xmin, xmax, ymin, ymax, Ax.AutoX, Ax.AutoY, Ax.LogX, Ax.LogY);
+            if(bStripChart && (dxPix != 0.0))
+                SetStripFollow(Ax.XMax >= NewestX());
+            InvalidateStripChart();
             update();
         } else {// is Zooming
             zoomEnd = event->pos();
@@ -974,19 +679,8 @@ Plot2D::mouseMoveEvent(QMouseEvent *event) {
         event->accept();
         return;
     }
-    double xval, yval;
-    if(Ax.LogX) {
-        xval = pow(10.0, log10(Ax.XMin)+(event->pos().rx()-Pf.left)/xfact);
-    }
-    else {
-        xval =Ax.XMin + (event->pos().rx()-Pf.left) / xfact;
-    }
-    if(Ax.LogY) {
-        yval = pow(10.0, log10(Ax.YMin)+(event->pos().ry()-Pf.bottom)/yfact);
-    }
-    else {
-        yval =Ax.YMin + (event->pos().ry()-Pf.bottom) / yfact;
-    }
+    double xval = ScreenTransform::toWorld(event->pos().rx(), XMapping());
+    double yval = ScreenTransform::toWorld(event->pos().ry(), YMapping());
     sMouseCoord = QString("X=%1 Y=%2")
               .arg(xval, 10, 'g', 7, ' ')
               .arg(yval, 10, 'g', 7, ' ');
@@ -1004,6 +698,14 @@ Plot2D::mouseDoubleClickEvent(QMouseEvent *event) {
     if(iRes==QDialog::Accepted) {
         Ax = axesDialog.newLimits;
         SetLimits (Ax.XMin, Ax.XMax, Ax.YMin, Ax.YMax, Ax.AutoX, Ax.AutoY, Ax.LogX, Ax.LogY);
+        if(bStripChart) {
+            stripSpan = Ax.XMax-Ax.XMin;
+            Ax.AutoX  = false;
+            Ax.LogX   = false;
+            SyncLogCache();
+            SetStripFollow(true);
+        }
+        InvalidateStripChart();
         update();
     }
 }
@@ -1011,19 +713,29 @@ Plot2D::mouseDoubleClickEvent(QMouseEvent *event) {
 
 void
 Plot2D::UpdatePlot() {
+    setMaxPoints(0); // The Max Data Points may have been changed
     labelPen = pPropertiesDlg->labelColor;
     gridPen  = pPropertiesDlg->gridColor;
     framePen = pPropertiesDlg->frameColor;
     gridPen.setWidth(pPropertiesDlg->gridPenWidth);
+    bStaticLayerDirty = true;
+    InvalidateStripChart();
     update();
 }
 
 
 void
 Plot2D::ClearPlot() {
+    if(pGLLayer)
+        pGLLayer->removeAll();
     while(!dataSetList.isEmpty()) {
         delete dataSetList.takeFirst();
     }
+    dataSetIndex.clear();
+    bBoundsDirty = true;
+    stripDrawn.clear();
+    stripWindows.clear();
+    InvalidateStripChart();
     update();
 }
 
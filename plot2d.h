@@ -19,15 +19,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include "plotpropertiesdlg.h"
-#include "datastream2d.h"
-#include "AxisLimits.h"
-#include "AxisFrame.h"
+#include "plotrenderer.h"
 
 #include <QWidget>
-#include <QPen>
+#include <QPixmap>
+#include <QImage>
+#include <QHash>
 
 
-class Plot2D : public QWidget
+QT_FORWARD_DECLARE_CLASS(Plot2DGLLayer)
+
+
+class Plot2D : public QWidget, public PlotRenderer
 {
     Q_OBJECT
 public:
@@ -36,49 +39,47 @@ public:
     void setTitle(QString sNewTitle);
     QSize minimumSizeHint() const;
     QSize sizeHint() const;
-    void SetLimits (double XMin, double XMax, double YMin, double YMax,
-                    bool AutoX, bool AutoY, bool LogX, bool LogY);
     DataStream2D* NewDataSet(int Id, int PenWidth, QColor Color, int Symbol, QString Title);
     bool DelDataSet(int Id);
     bool ClearDataSet(int Id);
     void NewPoint(int Id, double x, double y);
+    void NewPoints(int Id, const double* x, const double* y, int n);
+    void NewRows(MultiChannelStream* pStream, const double* t, const double* const* values, int n);
     void SetShowDataSet(int Id, bool Show);
     void SetShowTitle(int Id, bool show);
     void ClearPlot();
     void setMaxPoints(int nPoints);
     int  getMaxPoints();
+    // X follows the newest sample over a fixed span and the plot scrolls
+    // (panning back in time pauses the scroll)
+    void SetStripChart(bool bEnable, double xSpan);
+    // Draws the lines and the points on the GPU (see plot2dgl.h)
+    void SetOpenGL(bool bEnable);
 
 signals:
 
 public slots:
     void UpdatePlot();
-
-public:
-    static const int iline       = 0;
-    static const int ipoint      = 1;
-    static const int iplus       = 2;
-    static const int iper        = 3;
-    static const int istar       = 4;
-    static const int iuptriangle = 5;
-    static const int idntriangle = 6;
-    static const int icircle     = 7;
+    void onGLFailed();
 
 protected:
     void closeEvent(QCloseEvent *event);
     void keyPressEvent(QKeyEvent *e);
     void paintEvent(QPaintEvent *event);
     void DrawPlot(QPainter* painter, QFontMetrics fontMetrics);
-    void DrawFrame(QPainter* painter, QFontMetrics fontMetrics);
-    void XTicLin(QPainter* painter, QFontMetrics fontMetrics);
-    void XTicLog(QPainter* painter, QFontMetrics fontMetrics);
-    void YTicLin(QPainter* painter, QFontMetrics fontMetrics);
-    void YTicLog(QPainter* painter, QFontMetrics fontMetrics);
-    void DrawData(QPainter* painter, QFontMetrics fontMetrics);
-    void LinePlot(QPainter* painter, DataStream2D *pData);
-    void PointPlot(QPainter* painter, DataStream2D* pData);
-    void ScatterPlot(QPainter* painter, DataStream2D* pData);
-    void DrawLastPoint(QPainter* painter, DataStream2D* pData);
-    void ShowTitle(QPainter* painter, QFontMetrics fontMetrics, DataStream2D* pData);
+    bool IsStaticLayerValid() const;
+    void RenderStaticLayer(QFontMetrics fontMetrics);
+    DataStream2D* FindDataSet(int Id) const;
+    void DrawStripChart(QPainter* painter, QFontMetrics fontMetrics);
+    void ScrollDataLayer(int nPixels);
+    void AutoScaleStripY(double xMin);
+    void InvalidateStripChart();
+    bool IsScrolling() const override;
+    bool IsDrawnElsewhere(DataStream2D* pData) const override;
+    void SetStripFollow(bool bFollow);
+    bool IsGLReady() const;
+    bool IsDrawnByGL(DataStream2D* pData) const;
+    void UpdateGLLayer();
     void mousePressEvent(QMouseEvent *event);
     void mouseReleaseEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
@@ -86,19 +87,39 @@ protected:
 //  void wheelEvent(QWheelEvent* event);
 
 protected:
-    QList<DataStream2D*> dataSetList;
-    QPen labelPen;
-    QPen gridPen;
-    QPen framePen;
+    QHash<int, DataStream2D*> dataSetIndex; // Id -> Data Set
 
     bool bZooming;
     bool bShowMarker;
     double xMarker, yMarker;
-    AxisLimits Ax;
-    AxisFrame Pf;
-    QString sTitle;
     QString sMouseCoord;
-    double xfact, yfact;
     QPoint lastPos, zoomStart, zoomEnd;
     plotPropertiesDlg* pPropertiesDlg;
+    QPixmap    staticLayer;   // Cached background, frame, grid and labels
+    AxisLimits cachedAx;      // The limits staticLayer was drawn with
+    bool       bStaticLayerDirty;
+
+    // Strip chart: the data drawn so far, scrolled at every paint
+    bool       bStripChart;
+    bool       bStripFollow;  // Scrolling with the newest sample
+    bool       bStripDirty;   // Forces a full redraw of the data layer
+    double     stripSpan;
+    double     stripXMax;     // The X limits the data layer is drawn with
+    double     stripYMin, stripYMax;
+    QImage     dataLayer;
+    QHash<DataStream2D*, quint64> stripDrawn; // Samples already in dataLayer
+    // Y extrema of the samples in the strip, from the one just before
+    // its left edge (sequence start) to the last one seen (next-1)
+    struct StripWindow {
+        RunningExtremum yLow;
+        RunningExtremum yHigh;
+        int     capacity;
+        bool    bLog;
+        quint64 start;
+        quint64 next;
+        StripWindow() : yLow(false), yHigh(true), capacity(-1), bLog(false), start(0), next(0) {}
+    };
+    QHash<DataStream2D*, StripWindow> stripWindows;
+
+    Plot2DGLLayer* pGLLayer; // Null with the QPainter backend
 };
@@ -0,0 +1,18 @@
+// pixel = (f(x) - origin) * scale + offset, with f the identity or log10
+uniform vec2   base;      // Added back to the stored X before log10
+uniform vec2   origin;    // Linear axes: relative to base
+uniform vec2   scale;
+uniform vec2   offset;
+uniform vec2   logAxes;   // 1.0 for the log10 axes
+uniform vec2   viewport;  // Layer size in pixels
+uniform float  pointSize;
+attribute vec2 vertexPosition;
+
+void
+main() {
+    vec2 logValue = log(max(vertexPosition+base, vec2(1.0e-30))) / log(10.0);
+    vec2 value    = mix(vertexPosition, logValue, logAxes);
+    vec2 pixel    = (value-origin)*scale + offset;
+    gl_Position   = vec4(2.0*pixel.x/viewport.x-1.0, 1.0-2.0*pixel.y/viewport.y, 0.0, 1.0);
+    gl_PointSize  = pointSize;
+}
@@ -0,0 +1,80 @@
+#include "plot2dgl.h"
+
+#include <QOpenGLContext>
+#include <QDebug>
+
+
+Plot2DGLLayer::Plot2DGLLayer(QWidget *parent)
+    : QOpenGLWidget(parent)
+{
+    // Composited over the plot frame and transparent to the mouse:
+    // zoom and pan stay with Plot2D
+    setAttribute(Qt::WA_AlwaysStackOnTop);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+
+Plot2DGLLayer::~Plot2DGLLayer() {
+    if(!renderer.isReady())
+        return;
+    makeCurrent();
+    renderer.deleteBuffers();
+    doneCurrent();
+}
+
+
+bool
+Plot2DGLLayer::isReady() const {
+    return renderer.isReady();
+}
+
+
+void
+Plot2DGLLayer::setMappings(const AxisMapping& xMap, const AxisMapping& yMap) {
+    renderer.setMappings(xMap, yMap);
+}
+
+
+void
+Plot2DGLLayer::setSeries(const QList<DataStream2D*>& newSeries) {
+    renderer.setSeries(newSeries);
+}
+
+
+void
+Plot2DGLLayer::removeAll() {
+    renderer.clearSeries();
+    if(!renderer.isReady())
+        return;
+    makeCurrent();
+    renderer.deleteBuffers();
+    doneCurrent();
+}
+
+
+void
+Plot2DGLLayer::initializeGL() {
+    if(!context() || !context()->isValid()) {
+        qWarning() << "Plot2D: no OpenGL context, falling back to QPainter";
+        emit failed();
+        return;
+    }
+    if(!renderer.initialize(context())) {
+        qWarning() << "Plot2D: unable to init the shaders, falling back to QPainter";
+        emit failed();
+        return;
+    }
+}
+
+
+void
+Plot2DGLLayer::resizeGL(int w, int h) {
+    Q_UNUSED(w)
+    Q_UNUSED(h)
+}
+
+
+void
+Plot2DGLLayer::paintGL() {
+    renderer.render(size());
+}
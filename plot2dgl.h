@@ -0,0 +1,42 @@
+#pragma once
+
+#include "plot2dglrenderer.h"
+
+#include <QOpenGLWidget>
+#include <QList>
+
+
+QT_FORWARD_DECLARE_CLASS(DataStream2D)
+
+
+// OpenGL backend of Plot2D: a transparent layer laid over the plot
+// frame where a Plot2DGLRenderer draws the line and point series.
+// Only OpenGL (ES) 2.0 features are used: it runs on Mesa llvmpipe too
+// (LIBGL_ALWAYS_SOFTWARE=1). When the context or the shaders cannot be
+// created failed() is emitted and Plot2D goes back to QPainter.
+class Plot2DGLLayer
+    : public QOpenGLWidget
+{
+    Q_OBJECT
+
+public:
+    explicit Plot2DGLLayer(QWidget *parent);
+    ~Plot2DGLLayer() override;
+    bool isReady() const;
+    // Mappings in the coordinates of this layer
+    void setMappings(const AxisMapping& xMap, const AxisMapping& yMap);
+    void setSeries(const QList<DataStream2D*>& newSeries);
+    // To be called before the Data Sets are deleted
+    void removeAll();
+
+signals:
+    void failed();
+
+protected:
+    void initializeGL() override;
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
+
+private:
+    Plot2DGLRenderer renderer;
+};
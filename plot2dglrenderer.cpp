@@ -0,0 +1,183 @@
+#include "plot2dglrenderer.h"
+#include "plotrenderer.h"
+#include "datastream2d.h"
+
+#include <QOpenGLContext>
+#include <QVector2D>
+
+
+Plot2DGLRenderer::Plot2DGLRenderer()
+    : bReady(false)
+{
+    xMapping = { 0.0, 1.0, 0.0, false };
+    yMapping = { 0.0, 1.0, 0.0, false };
+}
+
+
+bool
+Plot2DGLRenderer::initialize(QOpenGLContext* pContext) {
+    initializeOpenGLFunctions();
+    bool bResult = true;
+    bResult &= program.addShaderFromSourceFile(QOpenGLShader::Vertex,   ":/plot2d.vert");
+    bResult &= program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/plot2d.frag");
+    bResult &= program.link();
+    if(!bResult)
+        return false;
+#ifdef GL_PROGRAM_POINT_SIZE
+    if(!pContext->isOpenGLES())
+        glEnable(GL_PROGRAM_POINT_SIZE);
+#else
+    Q_UNUSED(pContext)
+#endif
+    bReady = true;
+    return true;
+}
+
+
+bool
+Plot2DGLRenderer::isReady() const {
+    return bReady;
+}
+
+
+void
+Plot2DGLRenderer::setMappings(const AxisMapping& xMap, const AxisMapping& yMap) {
+    xMapping = xMap;
+    yMapping = yMap;
+}
+
+
+void
+Plot2DGLRenderer::setSeries(const QList<DataStream2D*>& newSeries) {
+    series = newSeries;
+}
+
+
+void
+Plot2DGLRenderer::clearSeries() {
+    series.clear();
+}
+
+
+void
+Plot2DGLRenderer::deleteBuffers() {
+    for(RingBuffer& buffer : buffers)
+        glDeleteBuffers(1, &buffer.vbo);
+    buffers.clear();
+}
+
+
+void
+Plot2DGLRenderer::render(QSize viewport) {
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if(!bReady)
+        return;
+    // Drop the buffers of the series no longer drawn
+    for(auto it=buffers.begin(); it!=buffers.end(); ) {
+        if(!series.contains(it.key())) {
+            glDeleteBuffers(1, &it.value().vbo);
+            it = buffers.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    program.bind();
+    program.setUniformValue("viewport", QVector2D(float(viewport.width()), float(viewport.height())));
+    program.setUniformValue("scale",    QVector2D(float(xMapping.scale), float(yMapping.scale)));
+    program.setUniformValue("offset",   QVector2D(float(xMapping.offset), float(yMapping.offset)));
+    program.setUniformValue("logAxes",  QVector2D(xMapping.bLog ? 1.0f : 0.0f, yMapping.bLog ? 1.0f : 0.0f));
+    int vertexLocation = program.attributeLocation("vertexPosition");
+    program.enableAttributeArray(vertexLocation);
+    for(int pos=0; pos<series.count(); pos++) {
+        DataStream2D* pData = series.at(pos);
+        RingBuffer& buffer = buffers[pData];
+        upload(pData, &buffer);
+        program.setAttributeBuffer(vertexLocation, GL_FLOAT, 0, 2, 2*sizeof(GLfloat));
+        drawSeries(pData, buffer);
+    }
+    program.disableAttributeArray(vertexLocation);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    program.release();
+}
+
+
+// Writes the samples added since the previous frame at their place in
+// the ring; everything is written again when the Data Set was cleared,
+// resized or too many samples were lost in between.
+// The slot 0 is mirrored after the last one, so that the ring can be
+// drawn as two strips joined together.
+void
+Plot2DGLRenderer::upload(DataStream2D* pData, RingBuffer* pBuffer) {
+    int capacity   = pData->getMaxPoints();
+    int nSamples   = pData->count();
+    quint64 nAdded = pData->added();
+    if(capacity < 1)
+        return;
+    if((pBuffer->vbo == 0) || (pBuffer->capacity != capacity)) {
+        if(pBuffer->vbo == 0)
+            glGenBuffers(1, &pBuffer->vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, pBuffer->vbo);
+        glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(capacity+1)*2*GLsizeiptr(sizeof(GLfloat)),
+                     nullptr, GL_DYNAMIC_DRAW);
+        pBuffer->capacity = capacity;
+        pBuffer->uploaded = 0;
+        pBuffer->xBase = 0.0;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, pBuffer->vbo);
+    int iFirst;
+    if((nAdded < pBuffer->uploaded) || (nAdded-pBuffer->uploaded > quint64(nSamples)) || (pBuffer->uploaded == 0)) {
+        iFirst = 0;
+        pBuffer->xBase = (nSamples > 0) ? pData->x(0) : 0.0;
+    }
+    else {
+        iFirst = nSamples-int(nAdded-pBuffer->uploaded);
+    }
+    quint64 oldest = nAdded-quint64(nSamples);
+    for(int i=iFirst; i<nSamples; ) {
+        int slot = int((oldest+quint64(i)) % quint64(capacity));
+        int n = qMin(nSamples-i, capacity-slot);
+        staging.resize(2*n);
+        GLfloat* pVertex = staging.data();
+        for(int j=0; j<n; j++) {
+            pVertex[2*j]   = GLfloat(pData->x(i+j)-pBuffer->xBase);
+            pVertex[2*j+1] = GLfloat(pData->y(i+j));
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, GLintptr(slot)*2*GLintptr(sizeof(GLfloat)),
+                        GLsizeiptr(n)*2*GLsizeiptr(sizeof(GLfloat)), pVertex);
+        if(slot == 0)
+            glBufferSubData(GL_ARRAY_BUFFER, GLintptr(capacity)*2*GLintptr(sizeof(GLfloat)),
+                            2*GLsizeiptr(sizeof(GLfloat)), pVertex);
+        i += n;
+    }
+    pBuffer->uploaded = nAdded;
+}
+
+
+void
+Plot2DGLRenderer::drawSeries(DataStream2D* pData, const RingBuffer& buffer) {
+    int nSamples = pData->count();
+    if((nSamples == 0) || (buffer.capacity < 1))
+        return;
+    double xOrigin = xMapping.bLog ? xMapping.origin : xMapping.origin-buffer.xBase;
+    program.setUniformValue("base",   QVector2D(float(buffer.xBase), 0.0f));
+    program.setUniformValue("origin", QVector2D(float(xOrigin), float(yMapping.origin)));
+    program.setUniformValue("color",  pData->GetProperties().Color);
+    bool bLine = pData->GetProperties().Symbol == PlotRenderer::iline;
+    GLenum mode = bLine ? GL_LINE_STRIP : GL_POINTS;
+    GLfloat size = GLfloat(qMax(pData->GetProperties().PenWidth, 1));
+    program.setUniformValue("pointSize", size);
+    glLineWidth(size);
+
+    int first = int((pData->added()-quint64(nSamples)) % quint64(buffer.capacity));
+    int nFirstRun = qMin(nSamples, buffer.capacity-first);
+    if(nFirstRun == nSamples) {
+        glDrawArrays(mode, first, nSamples);
+    }
+    else {
+        // The line continues on the mirrored copy of the slot 0
+        glDrawArrays(mode, first, bLine ? nFirstRun+1 : nFirstRun);
+        glDrawArrays(mode, 0, nSamples-nFirstRun);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "screentransform.h"
+
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QSize>
+
+
+QT_FORWARD_DECLARE_CLASS(DataStream2D)
+QT_FORWARD_DECLARE_CLASS(QOpenGLContext)
+
+
+// The drawing of the OpenGL backend of Plot2D, apart from the widget:
+// it draws in the framebuffer bound in the current context, so that
+// Plot2DGLLayer and the RenderBenchmark (an FBO over a QOffscreenSurface)
+// run the same code. Each series lives in a ring vertex buffer as large
+// as its DataStream2D, where only the samples arrived since the previous
+// frame are written (glBufferSubData); the axis scaling and the log10
+// mapping are done by the vertex shader.
+// All the GL calls must be made with the same context current.
+class Plot2DGLRenderer
+    : protected QOpenGLFunctions
+{
+public:
+    Plot2DGLRenderer();
+    // False when the shaders cannot be built
+    bool initialize(QOpenGLContext* pContext);
+    bool isReady() const;
+    // Mappings in the pixels of the viewport
+    void setMappings(const AxisMapping& xMap, const AxisMapping& yMap);
+    void setSeries(const QList<DataStream2D*>& newSeries);
+    void clearSeries();
+    void deleteBuffers();
+    void render(QSize viewport);
+
+protected:
+    struct RingBuffer {
+        GLuint  vbo;
+        int     capacity;  // Vertices (plus a copy of the first one)
+        quint64 uploaded;  // DataStream2D::added() when last written
+        double  xBase;     // Subtracted from X to keep the float precision
+    };
+    void upload(DataStream2D* pData, RingBuffer* pBuffer);
+    void drawSeries(DataStream2D* pData, const RingBuffer& buffer);
+
+private:
+    QOpenGLShaderProgram program;
+    QHash<DataStream2D*, RingBuffer> buffers;
+    QList<DataStream2D*> series;
+    QVector<GLfloat> staging;
+    AxisMapping xMapping;
+    AxisMapping yMapping;
+    bool bReady;
+};
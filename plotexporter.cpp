@@ -0,0 +1,185 @@
+#include "plotexporter.h"
+#include "plotrenderer.h"
+#include "datastream2d.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+#include <QImage>
+#include <QPainter>
+#include <QSvgGenerator>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QDebug>
+
+
+namespace {
+
+
+class SessionTask : public QRunnable
+{
+public:
+    SessionTask(const PlotExporter* pExporter, QString sFileName, QAtomicInt* pWritten)
+        : pExporter(pExporter)
+        , sFileName(sFileName)
+        , pWritten(pWritten)
+    {
+    }
+
+    void run() override {
+        if(pExporter->exportSession(sFileName))
+            pWritten->fetchAndAddRelaxed(2);
+        else
+            qWarning() << "PlotExporter: unable to export" << sFileName;
+    }
+
+private:
+    const PlotExporter* pExporter;
+    QString sFileName;
+    QAtomicInt* pWritten;
+};
+
+
+} // namespace
+
+
+PlotExporter::PlotExporter()
+    : format(Png)
+    , size(1280, 720)
+    , font(QString("Ubuntu"), 10, QFont::Bold)
+    , background(Qt::black)
+    , sOutputDir(".")
+{
+}
+
+
+void
+PlotExporter::setFormat(Format newFormat) {
+    format = newFormat;
+}
+
+
+void
+PlotExporter::setSize(QSize newSize) {
+    size = newSize;
+}
+
+
+void
+PlotExporter::setFont(QFont newFont) {
+    font = newFont;
+}
+
+
+void
+PlotExporter::setOutputDir(QString sNewDir) {
+    sOutputDir = sNewDir;
+}
+
+
+int
+PlotExporter::exportSessions(const QStringList& sessionFiles) {
+    QDir().mkpath(sOutputDir);
+    QAtomicInt nWritten(0);
+    QThreadPool* pPool = QThreadPool::globalInstance();
+    for(int i=0; i<sessionFiles.count(); i++)
+        pPool->start(new SessionTask(this, sessionFiles.at(i), &nWritten));
+    pPool->waitForDone();
+    return nWritten.loadAcquire();
+}
+
+
+// Lines starting with '#' and the column header are skipped
+bool
+PlotExporter::loadSession(QString sFileName, Session* pSession) {
+    QFile file(sFileName);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    *pSession = Session();
+    QTextStream in(&file);
+    QString sLine;
+    while(in.readLineInto(&sLine)) {
+        if(sLine.isEmpty() || sLine.startsWith('#'))
+            continue;
+        QStringList fields = sLine.split(',');
+        if(fields.count() < 5)
+            continue;
+        double values[5];
+        bool bOk = true;
+        for(int i=0; i<5 && bOk; i++)
+            values[i] = fields.at(i).toDouble(&bOk);
+        if(!bOk)
+            continue;
+        pSession->t.append(values[0]);
+        pSession->leftSetPt.append(values[1]);
+        pSession->leftSpeed.append(values[2]);
+        pSession->rightSetPt.append(values[3]);
+        pSession->rightSpeed.append(values[4]);
+    }
+    return !pSession->t.isEmpty();
+}
+
+
+// Called from the pool threads: nothing shared is modified
+bool
+PlotExporter::exportSession(QString sFileName) const {
+    Session session;
+    if(!loadSession(sFileName, &session))
+        return false;
+    QString sBase = QDir(sOutputDir).filePath(QFileInfo(sFileName).completeBaseName());
+    QString sExtension = (format == Svg) ? QString(".svg") : QString(".png");
+    bool bResult = renderPlot("Left Motor", session, session.leftSetPt, session.leftSpeed,
+                              sBase+QString("_LeftMotor")+sExtension);
+    bResult &= renderPlot("Right Motor", session, session.rightSetPt, session.rightSpeed,
+                          sBase+QString("_RightMotor")+sExtension);
+    return bResult;
+}
+
+
+// The same Data Sets, colors and pens of MainWindow::initPlots()
+bool
+PlotExporter::renderPlot(QString sPlotTitle, const Session& session,
+                         const QVector<double>& setPt, const QVector<double>& speed,
+                         QString sFileName) const
+{
+    int nSamples = session.t.count();
+    DataStream2D setPtData(1, 2, QColor(128, 128, 255), PlotRenderer::iline, "SetPt");
+    DataStream2D speedData(2, 2, QColor(255, 255,   0), PlotRenderer::iline, "Speed");
+    setPtData.setMaxPoints(nSamples);
+    speedData.setMaxPoints(nSamples);
+    setPtData.AddPoints(session.t.constData(), setPt.constData(), nSamples);
+    speedData.AddPoints(session.t.constData(), speed.constData(), nSamples);
+    setPtData.SetShow(true);
+    speedData.SetShow(true);
+    setPtData.SetShowTitle(true);
+    speedData.SetShowTitle(true);
+
+    PlotRenderer renderer;
+    renderer.SetPlotTitle(sPlotTitle);
+    renderer.SetPens(QPen(Qt::white), QPen(Qt::blue), QPen(Qt::blue));
+    renderer.SetLimits(0.0, 1.0, -1.0, 1.0, true, true, false, false);
+    renderer.AddDataSet(&setPtData);
+    renderer.AddDataSet(&speedData);
+
+    if(format == Svg) {
+        QSvgGenerator generator;
+        generator.setFileName(sFileName);
+        generator.setSize(size);
+        generator.setViewBox(QRect(QPoint(0, 0), size));
+        generator.setTitle(sPlotTitle);
+        QPainter painter;
+        if(!painter.begin(&generator))
+            return false;
+        painter.setFont(font);
+        renderer.Render(&painter, size, background);
+        return painter.end();
+    }
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    painter.setFont(font);
+    renderer.Render(&painter, size, background);
+    painter.end();
+    return image.save(sFileName, "PNG");
+}
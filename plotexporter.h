@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSize>
+#include <QFont>
+#include <QColor>
+
+
+// Renders recorded sessions (see MainWindow::onStartStopPushed()) to
+// PNG or SVG files: one picture of the Left Motor and one of the Right
+// Motor plot per session. Every session is a task of the global
+// QThreadPool; nothing needs a window, so it works headless too
+// (QT_QPA_PLATFORM=offscreen).
+class PlotExporter
+{
+public:
+    enum Format {
+        Png,
+        Svg
+    };
+
+    // The columns of a session file, in seconds and in the plot units
+    struct Session {
+        QVector<double> t;
+        QVector<double> leftSetPt,  leftSpeed;
+        QVector<double> rightSetPt, rightSpeed;
+    };
+
+    PlotExporter();
+    void setFormat(Format newFormat);
+    void setSize(QSize newSize);
+    void setFont(QFont newFont);
+    void setOutputDir(QString sNewDir);
+    // Blocks until every session is done; returns the files written
+    int  exportSessions(const QStringList& sessionFiles);
+    static bool loadSession(QString sFileName, Session* pSession);
+    bool exportSession(QString sFileName) const;
+
+protected:
+    bool renderPlot(QString sPlotTitle, const Session& session,
+                    const QVector<double>& setPt, const QVector<double>& speed,
+                    QString sFileName) const;
+
+protected:
+    Format  format;
+    QSize   size;
+    QFont   font;
+    QColor  background;
+    QString sOutputDir;
+};
@@ -105,7 +105,7 @@ void
 plotPropertiesDlg::setToolTips() {
     QString sHeader = QString("Enter values in range [%1 : %2]");
     gridPenWidthEdit.setToolTip(sHeader.arg(1).arg(10));
-    maxDataPointsEdit.setToolTip(sHeader.arg(1).arg(10000));
+    maxDataPointsEdit.setToolTip(sHeader.arg(1).arg(maxDataPointsLimit));
 }
 
 
@@ -245,7 +245,7 @@ plotPropertiesDlg::onChangeGridPenWidth(const QString sNewVal) {
 void
 plotPropertiesDlg::onChangeMaxDataPoints(const QString sNewVal) {
     if((sNewVal.toInt() > 0) &&
-       (sNewVal.toInt() < 10001))
+       (sNewVal.toInt() <= maxDataPointsLimit))
     {
         maxDataPoints = sNewVal.toInt();
         maxDataPointsEdit.setStyleSheet(sNormalStyle);
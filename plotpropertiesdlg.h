@@ -34,6 +34,9 @@ public:
     plotPropertiesDlg(QString sTitle, QWidget *parent=Q_NULLPTR);
     void restoreSettings();
 
+    // Line plots are decimated per pixel column: a large history is cheap
+    static const int maxDataPointsLimit = 1000000;
+
     QColor labelColor;
     QColor gridColor;
     QColor frameColor;
@@ -0,0 +1,1064 @@
+#include "plotrenderer.h"
+
+#include <float.h>
+#include <math.h>
+#include <QPainter>
+#include <QPaintEngine>
+#include <QCoreApplication>
+#include <QThread>
+#include <QtNumeric>
+
+
+static const double symbolHalfSize = 4.0;
+
+
+PlotRenderer::PlotRenderer()
+    : labelPen(Qt::white)
+    , gridPen(Qt::blue)
+    , framePen(Qt::blue)
+    , canvas(0, 0)
+    , xfact(1.0)
+    , yfact(1.0)
+    , bBoundsDirty(true)
+    , atlasRatio(0.0)
+    , bAtlasPixmapDirty(true)
+{
+}
+
+
+PlotRenderer::~PlotRenderer() {
+}
+
+
+void
+PlotRenderer::SetPens(QPen newLabelPen, QPen newGridPen, QPen newFramePen) {
+    labelPen = newLabelPen;
+    gridPen  = newGridPen;
+    framePen = newFramePen;
+}
+
+
+void
+PlotRenderer::SetPlotTitle(QString sNewTitle) {
+    sTitle = sNewTitle;
+}
+
+
+void
+PlotRenderer::AddDataSet(DataStream2D* pData) {
+    dataSetList.append(pData);
+    pData->setLogCache(Ax.LogX, Ax.LogY);
+    bBoundsDirty = true;
+}
+
+
+bool
+PlotRenderer::IsScrolling() const {
+    return false;
+}
+
+
+bool
+PlotRenderer::IsDrawnElsewhere(DataStream2D* pData) const {
+    Q_UNUSED(pData)
+    return false;
+}
+
+
+// Room for the Y labels on the left, the exponent on the right,
+// the title on top and the X labels below
+void
+PlotRenderer::SetFrame(QSize size, QFontMetrics fontMetrics) {
+    canvas = size;
+    Pf.left = fontMetrics.horizontalAdvance("-0.00000") + 2.0;
+    Pf.right = size.width() - fontMetrics.horizontalAdvance("x10-999") - 5.0;
+    Pf.top = 2.0 * fontMetrics.height();
+    Pf.bottom = size.height() - 3.0*fontMetrics.height();
+}
+
+
+// Everything in a single pass: no cached layers. The autoscaled limits
+// are the exact data bounds, so that the same session always gives the
+// same picture.
+void
+PlotRenderer::Render(QPainter* painter, QSize size, QColor background) {
+    painter->fillRect(QRect(QPoint(0, 0), size), background);
+    if(Ax.AutoX || Ax.AutoY)
+        SetLimits(Ax.XMin, Ax.XMax, Ax.YMin, Ax.YMax,
+                  Ax.AutoX, Ax.AutoY, Ax.LogX, Ax.LogY);
+    QFontMetrics fontMetrics = painter->fontMetrics();
+    SetFrame(size, fontMetrics);
+    DrawFrame(painter, fontMetrics);
+    DrawData(painter, fontMetrics);
+}
+
+
+void
+PlotRenderer::SetLimits (double XMin, double XMax, double YMin, double YMax,
+                   bool AutoX, bool AutoY, bool LogX, bool LogY)
+{
+    Ax.XMin  = XMin;
+    Ax.XMax  = XMax;
+    Ax.YMin  = YMin;
+    Ax.YMax  = YMax;
+    Ax.AutoX = AutoX;
+    Ax.AutoY = AutoY;
+    Ax.LogX  = LogX;
+    Ax.LogY  = LogY;
+
+    if(!dataSetList.isEmpty()) {
+        if(AutoX | AutoY) {
+            bool EmptyData = true;
+            if(Ax.AutoX) {
+                if(Ax.LogX) {
+                    XMin = double(FLT_MAX);
+                    XMax = double(FLT_MIN);
+                } else {
+                    XMin = double(FLT_MAX);
+                    XMax =-double(FLT_MAX);
+                }
+            }
+            if(Ax.AutoY) {
+                if(Ax.LogY) {
+                    YMin = double(FLT_MAX);
+                    YMax = double(FLT_MIN);
+                } else {
+                    YMin = double(FLT_MAX);
+                    YMax =-double(FLT_MAX);
+                }
+            }
+            DataStream2D* pData;
+            for(int pos=0; pos<dataSetList.count(); pos++) {
+                pData = dataSetList.at(pos);
+                if(pData->isShown) {
+                    if(pData->count() != 0) {
+                        EmptyData = false;
+                        pData->updateBounds(); // A shared source may have grown
+                        if(Ax.AutoX) {
+                            if(XMin > pData->minx) {
+                                XMin = pData->minx;
+                            }
+                            if(XMax < pData->maxx) {
+                                XMax = pData->maxx;
+                            }
+                        }// if(Ax.AutoX)
+                        if(Ax.AutoY) {
+                            if(YMin > pData->miny) {
+                                YMin = pData->miny;
+                            }
+                            if(YMax < pData->maxy) {
+                                YMax = pData->maxy;
+                            }
+                        }// if(Ax.AutoY)
+                    }// if(pData->count() != 0)
+                }// if(pData->isShowed)
+            }// while (pos != NULL)
+            if(EmptyData) {
+                XMin = Ax.XMin;
+                XMax = Ax.XMax;
+                YMin = Ax.YMin;
+                YMax = Ax.YMax;
+            }
+        }
+    }
+    if(abs(XMin-XMax) < double(FLT_MIN)) {
+        XMin  -= 0.05*(XMax+XMin)+double(FLT_MIN);
+        XMax  += 0.05*(XMax+XMin)+double(FLT_MIN);
+    }
+    if(abs(YMin-YMax)  < double(FLT_MIN)) {
+        YMin  -= 0.05*(YMax+YMin)+double(FLT_MIN);
+        YMax  += 0.05*(YMax+YMin)+double(FLT_MIN);
+    }
+    if(XMin > XMax) {
+        double tmp = XMin;
+        XMin = XMax;
+        XMax = tmp;
+    }
+    if(YMin > YMax) {
+        double tmp = YMin;
+        YMin = YMax;
+        YMax = tmp;
+    }
+    if(LogX) {
+        if(XMin <= 0.0) XMin = double(FLT_MIN);
+        if(XMax <= 0.0) XMax = 2.0*double(FLT_MIN);
+    }
+    if(LogY) {
+        if(YMin <= 0.0) YMin = double(FLT_MIN);
+        if(YMax <= 0.0) YMax = 2.0*double(FLT_MIN);
+    }
+    Ax.XMin  = XMin;
+    Ax.XMax  = XMax;
+    Ax.YMin  = YMin;
+    Ax.YMax  = YMax;
+    SyncLogCache();
+}
+
+
+// The Data Sets keep their log10 columns only while an axis is log
+void
+PlotRenderer::SyncLogCache() {
+    for(int pos=0; pos<dataSetList.count(); pos++)
+        dataSetList.at(pos)->setLogCache(Ax.LogX, Ax.LogY);
+}
+
+
+// Called at every paint while autoscaling. Every Data Set keeps its own
+// running extrema, so the plot bounds are gathered (once per Data Set)
+// only when some samples were added, evicted or hidden since the
+// previous paint.
+void
+PlotRenderer::AutoScale() {
+    if(!bBoundsDirty) return;
+    bBoundsDirty = false;
+    bool bEmpty = true;
+    double xmin = DBL_MAX, xmax = -DBL_MAX;
+    double ymin = DBL_MAX, ymax = -DBL_MAX;
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        DataStream2D* pData = dataSetList.at(pos);
+        if(!pData->isShown || (pData->count() == 0))
+            continue;
+        pData->updateBounds(); // A shared source may have grown
+        // A channel of a shared source holding only NaN rows
+        if(qIsNaN(pData->miny) || qIsNaN(pData->minx))
+            continue;
+        bEmpty = false;
+        double x0 = pData->minx, x1 = pData->maxx;
+        double y0 = pData->miny, y1 = pData->maxy;
+        // On a log axis only the positive samples count
+        if(Ax.LogX && pData->hasLogX() && !qIsNaN(pData->minLogX)) {
+            x0 = pow(10.0, pData->minLogX);
+            x1 = pow(10.0, pData->maxLogX);
+        }
+        if(Ax.LogY && pData->hasLogY() && !qIsNaN(pData->minLogY)) {
+            y0 = pow(10.0, pData->minLogY);
+            y1 = pow(10.0, pData->maxLogY);
+        }
+        xmin = qMin(xmin, x0);
+        xmax = qMax(xmax, x1);
+        ymin = qMin(ymin, y0);
+        ymax = qMax(ymax, y1);
+    }
+    if(bEmpty) return;
+    if(Ax.AutoX)
+        AutoRange(xmin, xmax, Ax.LogX, &Ax.XMin, &Ax.XMax);
+    if(Ax.AutoY)
+        AutoRange(ymin, ymax, Ax.LogY, &Ax.YMin, &Ax.YMax);
+}
+
+
+// Autoscale hysteresis: the axis grows, with some headroom, as soon as
+// the data leave it and shrinks only when the data use less than half
+// of it. Small changes of the data thus leave the limits, the tick
+// labels and the cached static layer untouched.
+bool
+PlotRenderer::AutoRange(double dataMin, double dataMax, bool bLog, double* pMin, double* pMax) {
+    const double headroom = 0.1;  // Of the data span, on each side
+    const double minFill  = 0.5;  // Of the axis span
+    double lo = *pMin;
+    double hi = *pMax;
+    if(bLog) {
+        dataMin = log10(qMax(dataMin, double(FLT_MIN)));
+        dataMax = log10(qMax(dataMax, double(FLT_MIN)));
+        lo = log10(qMax(lo, double(FLT_MIN)));
+        hi = log10(qMax(hi, double(FLT_MIN)));
+    }
+    double span = dataMax-dataMin;
+    if(span < 0.1*fabs(dataMax))
+        span = 0.1*fabs(dataMax);
+    if(span < double(FLT_MIN))
+        span = 1.0;
+    bool bInside = (dataMin >= lo) && (dataMax <= hi);
+    if(bInside && (span >= minFill*(hi-lo)))
+        return false;
+    lo = dataMin - headroom*span;
+    hi = dataMax + headroom*span;
+    if(bLog) {
+        lo = pow(10.0, lo);
+        hi = pow(10.0, hi);
+    }
+    *pMin = lo;
+    *pMax = hi;
+    return true;
+}
+
+
+void
+PlotRenderer::DrawData(QPainter* painter, QFontMetrics fontMetrics) {
+    if(dataSetList.isEmpty()) return;
+    DataStream2D* pData;
+    QRectF frameRect(Pf.left, Pf.top, Pf.right-Pf.left+1.0, Pf.bottom-Pf.top+1.0);
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        pData = dataSetList.at(pos);
+        if(pData->isShown) {
+            // The series are clipped by the painter, not segment by segment
+            painter->setClipRect(frameRect);
+            if(!IsDrawnElsewhere(pData))
+                DrawSeries(painter, pData, 0);
+            painter->setClipping(false);
+            if(pData->bShowCurveTitle) ShowTitle(painter, fontMetrics, pData);
+        }
+    }
+}
+
+
+void
+PlotRenderer::DrawSeries(QPainter* painter, DataStream2D* pData, int iFirst) {
+    if(pData->GetProperties().Symbol == iline) {
+        LinePlot(painter, pData, iFirst);
+    } else if(pData->GetProperties().Symbol == ipoint) {
+        PointPlot(painter, pData, iFirst);
+    } else {
+        ScatterPlot(painter, pData, iFirst);
+    }
+}
+
+
+void
+PlotRenderer::ShowTitle(QPainter* painter, QFontMetrics fontMetrics, DataStream2D *pData) {
+    QPen titlePen = QPen(pData->GetProperties().Color);
+    painter->setPen(titlePen);
+    painter->drawText(int(Pf.right+4), int(Pf.top+fontMetrics.height()*(pData->GetId())), pData->GetTitle());
+}
+
+
+void
+PlotRenderer::XTicLin(QPainter* painter, QFontMetrics fontMetrics) {
+    double xmax, xmin;
+    double dx, dxx, b, fmant;
+    int isx, ic, iesp, jy, isig, ix, ix0, iy0;
+    QString Label;
+
+    if (Ax.XMax <= 0.0) {
+        xmax =-Ax.XMin;	xmin=-Ax.XMax; isx= -1;
+    } else {
+        xmax = Ax.XMax; xmin= Ax.XMin; isx= 1;
+    }
+    dx = xmax - xmin;
+    b = log10(dx);
+    ic = qRound(b) - 2;
+    dx = double(qRound(pow(10.0, (b-ic-1.0))));
+
+    if(dx < 11.0) dx = 10.0;
+    else if(dx < 28.0) dx = 20.0;
+    else if(dx < 70.0) dx = 50.0;
+    else dx = 100.0;
+
+    dx = dx * pow(10.0, double(ic));
+    xfact = (Pf.right-Pf.left) / (xmax-xmin);
+    dxx = (xmax+dx) / dx;
+    dxx = floor(dxx) * dx;
+    iy0 = int(Pf.bottom + fontMetrics.height()+5);
+    iesp = int(floor(log10(dxx)));
+    if (dxx > xmax) dxx = dxx - dx;
+    do {
+        if(isx == -1)
+            ix = int(Pf.right-(dxx-xmin) * xfact);
+        else
+            ix = int((dxx-xmin) * xfact + Pf.left);
+        jy = int(Pf.bottom + 5);// Perche' 5 ?
+        painter->setPen(gridPen);
+        painter->drawLine(QLine(ix, int(Pf.top), ix, jy));
+        isig = 0;
+        if(dxx == 0.0)
+            fmant= 0.0;
+        else {
+            isig = int(dxx/fabs(dxx));
+            dxx = fabs(dxx);
+            fmant = log10(dxx) - double(iesp);
+            fmant = pow(10.0, fmant)*10000.0 + 0.5;
+            fmant = floor(fmant)/10000.0;
+            fmant = isig * fmant;
+        }
+        if(double(isx*fmant) <= -10.0)
+            Label = QString("%1").arg(double(isx*fmant), 6, 'f', 2, ' ');
+        else
+            Label = QString("%1").arg(double(isx*fmant), 6, 'f', 3, ' ');
+        ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
+        painter->setPen(labelPen);
+        painter->drawText(QPoint(ix0, iy0), Label);
+        dxx = isig*dxx - dx;
+    } while(dxx >= xmin);
+    painter->setPen(labelPen);
+    painter->drawText(QPoint(int(Pf.right + 2),	int(Pf.bottom - 0.5*fontMetrics.height())), "x10");
+    int icx = fontMetrics.horizontalAdvance("x10 ");
+    Label = QString("%1").arg(iesp, 0, 10, QLatin1Char(' '));
+    painter->setPen(labelPen);
+    painter->drawText(QPoint(int(Pf.right+icx),	int(Pf.bottom - fontMetrics.height())), Label);
+}
+
+
+void
+PlotRenderer::YTicLin(QPainter* painter, QFontMetrics fontMetrics) {
+    double ymax, ymin;
+    double dy, dyy, b, fmant;
+    int isy, icc, iesp, jx, isig, iy, ix0, iy0;
+    QString Label;
+
+    if (Ax.YMax <= 0.0) {
+        ymax = -Ax.YMin; ymin= -Ax.YMax; isy= -1;
+    } else {
+        ymax = Ax.YMax; ymin= Ax.YMin; isy= 1;
+    }
+    dy = ymax - ymin;
+    b = log10(dy);
+    icc = qRound(b) - 2;
+    dy = double(qRound(pow(10.0, (b-icc-1.0))));
+
+    if(dy < 11.0) dy = 10.0;
+    else if(dy < 28.0) dy = 20.0;
+    else if(dy < 70.0) dy = 50.0;
+    else dy = 100.0;
+
+    dy = dy * pow(10.0, double(icc));
+    yfact = (Pf.top-Pf.bottom) / (ymax-ymin);
+    dyy = (ymax+dy) / dy;
+    dyy = floor(dyy) * dy;
+    iesp = int(floor(log10(dyy)));
+    if(dyy > ymax) dyy = dyy - dy;
+    do {
+        if(isy == -1)
+            iy = int(Pf.top - (dyy-ymin) * yfact);
+        else
+            iy = int((dyy-ymin) * yfact + Pf.bottom);
+        jx = int(Pf.right);
+        painter->setPen(gridPen);
+        painter->drawLine(QLine(int(Pf.left-5), iy, jx, iy));
+        isig = 0;
+        if(dyy == 0.0)
+            fmant = 0.0;
+        else{
+            isig = int(dyy/fabs(dyy));
+            dyy = fabs(dyy);
+            fmant = log10(dyy) - double(iesp);
+            fmant = pow(10.0, fmant)*10000.0 + 0.5;
+            fmant = floor(fmant)/10000.0;
+            fmant = isig * fmant;
+        }
+        if(double(isy*fmant) <= -10.0)
+            Label = QString("%1").arg(double(isy*fmant), 7, 'f', 3, ' ');
+        else
+            Label = QString("%1").arg(double(isy*fmant), 7, 'f', 4, ' ');
+        ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
+        iy0 = iy + fontMetrics.height()/2;
+        painter->setPen(labelPen);
+        painter->drawText(QPoint(ix0, iy0), Label);
+        dyy = isig*dyy - dy;
+    }	while (dyy >= ymin);
+    QPoint point(int(Pf.left), int(Pf.top-0.5*fontMetrics.height()));
+    painter->setPen(labelPen);
+    painter->drawText(point, "x10");
+    int icx = fontMetrics.horizontalAdvance("x10 ");
+    Label = QString("%1").arg(iesp, 0, 10, QLatin1Char(' '));
+    painter->setPen(labelPen);
+    painter->drawText(QPoint(int(int(Pf.left)+icx),int(Pf.top-fontMetrics.height())),Label);
+}
+
+
+void
+PlotRenderer::XTicLog(QPainter* painter, QFontMetrics fontMetrics) {
+    int i, ix, ix0, iy0, jy, j;
+    double dx;
+    QString Label;
+
+    jy = int(Pf.bottom + 5);// Perche' 5 ?
+    iy0 = int(Pf.bottom + fontMetrics.height()+5);
+
+    if(Ax.XMin < double(FLT_MIN)) Ax.XMin = double(FLT_MIN);
+    if(Ax.XMax < double(FLT_MIN)) Ax.XMax = 10.0*double(FLT_MIN);
+
+    double xlmin = log10(Ax.XMin);
+    int minx = int(xlmin);
+    if((xlmin < 0.0) && fabs(xlmin-minx) <= double(FLT_MIN)) minx= minx - 1;
+
+    double xlmax = log10(Ax.XMax);
+    int maxx = int(xlmax);
+    if((xlmax > 0.0) && fabs(xlmax-maxx) <= double(FLT_MIN)) maxx= maxx + 1;
+
+    xfact = (Pf.right-Pf.left) / ((xlmax-xlmin)+double(FLT_MIN));
+
+    bool init = true;
+    int decades = maxx - minx;
+    double x = pow(10.0, minx);
+    if(decades < 6) {
+        for(i=0; i<decades; i++) {
+            dx = pow(10.0, (minx + i));
+            if(x >= Ax.XMin) {
+                ix = int(Pf.left + (log10(x)-xlmin)*xfact);
+                Label = QString("%1").arg(x, 7, 'e', 0, ' ');
+                ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
+                painter->setPen(labelPen);
+                painter->drawText(QPoint(ix0, iy0), Label);
+                init = false;
+            }
+            for(j=1; j<10; j++){
+                x = x + dx;
+                if((x >= Ax.XMin) && (x <= Ax.XMax)) {
+                    ix = int(Pf.left + (log10(x)-xlmin)*xfact);
+                    painter->setPen(gridPen);
+                    painter->drawLine(QLine(ix, int(Pf.top), ix, jy));
+                    Label = QString("%1").arg(x, 7, 'e', 0, ' ');
+                    if(init || (j == 9 && decades == 1)) {
+                        ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
+                        painter->setPen(labelPen);
+                        painter->drawText(QPoint(ix0, iy0), Label);
+                        init = false;
+                    } else if (decades == 1) {
+                        Label = Label.left(2);
+                        ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
+                        painter->setPen(labelPen);
+                        painter->drawText(QPoint(ix0, iy0), Label);
+                    }
+                }
+            }
+        }// for(i=0; i<decades; i++)
+        if((decades != 1) && (x <= Ax.XMax)) {
+            Label = QString("%1").arg(x, 7, 'e', 0, ' ');
+            ix = int(Pf.left + (log10(x)-xlmin)*xfact);
+            ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
+            painter->setPen(labelPen);
+            painter->drawText(QPoint(ix0, iy0), Label);
+        }
+    } else {// decades > 5
+        for(i=1; i<=decades; i++) {
+            x = pow(10.0, minx + i);
+            if((x >= Ax.XMin) && (x <= Ax.XMax)) {
+                ix = int(Pf.left + (log10(x)-xlmin)*xfact);
+                painter->setPen(gridPen);
+                painter->drawLine(QLine(ix, int(Pf.top),ix, jy));
+                Label = QString("%1").arg(x, 7, 'e', 0, ' ');
+                ix0 = ix - fontMetrics.horizontalAdvance(Label)/2;
+                painter->setPen(labelPen);
+                painter->drawText(QPoint(ix0, iy0), Label);
+            }
+        }
+    }//if(decades < 6)
+}
+
+
+void
+PlotRenderer::YTicLog(QPainter* painter, QFontMetrics fontMetrics) {
+    int i, iy, ix0, iy0, j;
+    double dy;
+    QString Label;
+
+    if(Ax.YMin < double(FLT_MIN)) Ax.YMin = double(FLT_MIN);
+    if(Ax.YMax < double(FLT_MIN)) Ax.YMax = 10.0*double(FLT_MIN);
+
+    double ylmin = log10(Ax.YMin);
+    int miny = int(ylmin);
+    if((ylmin < 0.0) && fabs(ylmin-miny) <= double(FLT_MIN)) miny= miny - 1;
+
+    double ylmax = log10(Ax.YMax);
+    int maxy = int(ylmax);
+    if((ylmax > 0.0) && fabs(ylmax-maxy) <= double(FLT_MIN)) maxy= maxy + 1;
+
+    yfact = (Pf.top-Pf.bottom) / ((ylmax-ylmin)+double(FLT_MIN));
+
+    bool init = true;
+    int decades = maxy - miny;
+    double y = pow(10.0, miny);
+    if(decades < 6) {
+        for(i=0; i<decades; i++) {
+            dy = pow(10.0, (miny + i));
+            if(y >= Ax.YMin) {
+                iy = int(Pf.bottom + (log10(y)-ylmin)*yfact);
+                Label = QString("%1").arg(y, 7, 'e', 0, ' ');
+                ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
+                iy0 = iy + fontMetrics.height()/2;
+                painter->setPen(labelPen);
+                painter->drawText(QPoint(ix0, iy0), Label);
+                init = false;
+            }
+            for(j=1; j<10; j++){
+                y = y + dy;
+                if((y >= Ax.YMin) && (y <= Ax.YMax)) {
+                    iy = int(Pf.bottom + (log10(y)-ylmin)*yfact);
+                    painter->setPen(gridPen);
+                    painter->drawLine(QLine(int(Pf.left-5), iy, int(Pf.right), iy));
+                    Label = QString("%1").arg(y, 7, 'e', 0, ' ');
+                    if(init || (j == 9 && decades == 1)) {
+                        ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
+                        iy0 = iy + fontMetrics.height()/2;
+                        painter->setPen(labelPen);
+                        painter->drawText(QPoint(ix0, iy0), Label);
+                        init = false;
+                    } else if (decades == 1) {
+                        Label = Label.left(2);
+                        ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
+                        iy0 = iy + fontMetrics.height()/2;
+                        painter->setPen(labelPen);
+                        painter->drawText(QPoint(ix0, iy0), Label);
+                    }
+                }
+            }
+        }// for(i=0; i<decades; i++)
+        if((decades != 1) && (y <= Ax.YMax)) {
+            Label = QString("%1").arg(y, 7, 'e', 0, ' ');
+            iy = int(Pf.bottom - (log10(y)-ylmin)*yfact);
+            ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
+            iy0 = iy + fontMetrics.height()/2;
+            painter->setPen(labelPen);
+            painter->drawText(QPoint(ix0, iy0), Label);
+        }
+    } else {// decades > 5
+        for(i=1; i<=decades; i++) {
+            y = pow(10.0, miny + i);
+            if((y >= Ax.YMin) && (y <= Ax.YMax)) {
+                iy = int(Pf.bottom + (log10(y)-ylmin)*yfact);
+                painter->setPen(gridPen);
+                painter->drawLine(QLine(int(Pf.left-5), iy, int(Pf.right), iy));
+                Label = QString("%1").arg(y, 7, 'e', 0, ' ');
+                ix0 = int(Pf.left - fontMetrics.horizontalAdvance(Label) - 5);
+                iy0 = iy + fontMetrics.height()/2;
+                painter->setPen(labelPen);
+                painter->drawText(QPoint(ix0, iy0), Label);
+            }
+        }
+    }//if(decades < 6)
+}
+
+
+void
+PlotRenderer::DrawFrame(QPainter* painter, QFontMetrics fontMetrics) {
+    // The X ticks of a strip chart move at every paint: they are not cached
+    if(!IsScrolling()) {
+        if(Ax.LogX) XTicLog(painter, fontMetrics); else XTicLin(painter, fontMetrics);
+    }
+    if(Ax.LogY) YTicLog(painter, fontMetrics); else YTicLin(painter, fontMetrics);
+
+    painter->setPen(framePen);
+    painter->drawLine(QLine(int(Pf.left), int(Pf.bottom), int(Pf.right), int(Pf.bottom)));
+    painter->drawLine(QLine(int(Pf.right), int(Pf.bottom), int(Pf.right), int(Pf.top)));
+    painter->drawLine(QLine(int(Pf.right), int(Pf.top), int(Pf.left), int(Pf.top)));
+    painter->drawLine(QLine(int(Pf.left), int(Pf.top), int(Pf.left), int(Pf.bottom)));
+
+    painter->setPen(labelPen);
+    int icx = fontMetrics.horizontalAdvance((sTitle));
+    painter->drawText(QPoint(int((canvas.width()-icx)/2), int(fontMetrics.height())), sTitle);
+}
+
+
+AxisMapping
+PlotRenderer::XMapping() const {
+    AxisMapping map;
+    map.bLog   = Ax.LogX;
+    map.origin = Ax.LogX ? log10(Ax.XMin) : Ax.XMin;
+    map.scale  = xfact;
+    map.offset = Pf.left;
+    return map;
+}
+
+
+AxisMapping
+PlotRenderer::YMapping() const {
+    AxisMapping map;
+    map.bLog   = Ax.LogY;
+    map.origin = Ax.LogY ? log10(Ax.YMin) : Ax.YMin;
+    map.scale  = yfact;
+    map.offset = Pf.bottom;
+    return map;
+}
+
+
+// World to screen coordinates of a series (from its iFirst-th sample)
+// through the vectorized kernel. The samples that cannot be shown on a
+// log axis map to NaN. When the Data Set caches the log10 of its samples
+// for the log axes in use, those are mapped linearly.
+void
+PlotRenderer::MapSeries(DataStream2D* pData, int iFirst) {
+    int iMax = pData->count();
+    screenPoints.resize(iMax-iFirst);
+    static_assert(sizeof(QPointF) == 2*sizeof(double), "QPointF must be two doubles");
+    double* pXY = reinterpret_cast<double*>(screenPoints.data());
+    AxisMapping xMap = XMapping();
+    AxisMapping yMap = YMapping();
+    bool bLogCache = (pData->hasLogX() || pData->hasLogY()) &&
+                     (pData->hasLogX() == Ax.LogX) && (pData->hasLogY() == Ax.LogY);
+    if(bLogCache) {
+        xMap.bLog = false;
+        yMap.bLog = false;
+    }
+    const double* pX;
+    const double* pY;
+    const float*  pFloatY;
+    // The ring buffer has at most two contiguous runs
+    for(int i=iFirst; i<iMax; ) {
+        int n;
+        if(pData->floatValues()) {
+            n = pData->contiguous(i, &pX, &pFloatY);
+            // Widened in place, the kernels work on doubles
+            yBuffer.resize(n);
+            double* pWide = yBuffer.data();
+            for(int j=0; j<n; j++)
+                pWide[j] = double(pFloatY[j]);
+            pY = pWide;
+        }
+        else if(bLogCache) {
+            n = pData->contiguousLog(i, &pX, &pY);
+        }
+        else {
+            n = pData->contiguous(i, &pX, &pY);
+        }
+        ScreenTransform::mapPoints(pX, pY, size_t(n), xMap, yMap, pXY+2*(i-iFirst));
+        i += n;
+    }
+}
+
+
+// Maps the visible part of the history, at the coarsest level with no
+// more than two buckets per pixel column (a minimum and a maximum each),
+// followed by the newest samples not yet in a bucket. The cost depends
+// on the plot width, not on the session length.
+void
+PlotRenderer::MapHistory(DataStream2D* pData) {
+    const MinMaxPyramid* pHistory = pData->history();
+    int maxBuckets = 2*int(Pf.right-Pf.left+1.0);
+    int k = pHistory->selectLevel(Ax.XMin, Ax.XMax, maxBuckets);
+    historyX.resize(0);
+    historyY.resize(0);
+    if(k > 0) {
+        const QVector<MinMaxPyramid::Bucket>& level = pHistory->level(k);
+        // One more bucket on both sides to join the frame edges
+        int iStart = qMax(0, pHistory->lowerBound(k, Ax.XMin)-1);
+        int iEnd   = qMin(level.count(), pHistory->lowerBound(k, Ax.XMax)+1);
+        for(int i=iStart; i<iEnd; i++) {
+            const MinMaxPyramid::Bucket& bucket = level.at(i);
+            historyX.append(bucket.x);
+            historyY.append(double(bucket.yMin));
+            historyX.append(bucket.x);
+            historyY.append(double(bucket.yMax));
+        }
+        if(iEnd < level.count()) {
+            // The newest samples are out of the frame
+            MapWorldPoints();
+            return;
+        }
+    }
+    // After the last bucket: the newest samples from the ring and, when
+    // the ring is shorter, the older ones from the open buckets of the
+    // finer levels (a level covers the pending samples of the next)
+    quint64 nRing = quint64(pData->count());
+    int j = k;
+    while((j > 0) && (pHistory->pending(j) > nRing)) {
+        const MinMaxPyramid::Bucket* pOpen = pHistory->openBucket(j);
+        if(pOpen) {
+            historyX.append(pOpen->x);
+            historyY.append(double(pOpen->yMin));
+            historyX.append(pOpen->x);
+            historyY.append(double(pOpen->yMax));
+        }
+        j--;
+    }
+    int nTail = int(qMin(pHistory->pending(j), nRing));
+    for(int i=pData->count()-nTail; i<pData->count(); i++) {
+        historyX.append(pData->x(i));
+        historyY.append(pData->y(i));
+    }
+    MapWorldPoints();
+}
+
+
+void
+PlotRenderer::MapWorldPoints() {
+    int nPoints = historyX.count();
+    screenPoints.resize(nPoints);
+    ScreenTransform::mapPoints(historyX.constData(), historyY.constData(), size_t(nPoints),
+                               XMapping(), YMapping(),
+                               reinterpret_cast<double*>(screenPoints.data()));
+}
+
+
+// Keeps in screenPoints only the points inside the frame;
+// returns how many they are.
+int
+PlotRenderer::ClipPoints() {
+    int iMax = screenPoints.count();
+    QPointF* pPoint = screenPoints.data();
+    int nInside = 0;
+    for(int i=0; i<iMax; i++) {
+        // False for NaN too
+        if((pPoint[i].x() >= Pf.left) && (pPoint[i].x() <= Pf.right) &&
+           (pPoint[i].y() >= Pf.top)  && (pPoint[i].y() <= Pf.bottom))
+            pPoint[nInside++] = pPoint[i];
+    }
+    return nInside;
+}
+
+
+// M4 decimation of the mapped series: the consecutive points falling in
+// the same pixel column are reduced to the first, the minimum, the
+// maximum and the last one (in their original order). The polyline is
+// unchanged but it has at most 4 vertices per column. All the points
+// on the left (right) of the frame fall in a single column, so the
+// vertices are bounded by the plot width also when zoomed in.
+// NaN points (not representable) split the line: they are kept as such.
+void
+PlotRenderer::DecimateLine() {
+    linePoints.clear();
+    int iMax = screenPoints.count();
+    const QPointF* pPoint = screenPoints.constData();
+    QPointF first, last, low, high;
+    int iLow = 0, iHigh = 0;
+    int column = 0;
+    bool bOpen = false; // A column is being accumulated
+    for(int i=0; i<iMax; i++) {
+        const QPointF& point = pPoint[i];
+        if(qIsNaN(point.x()) || qIsNaN(point.y())) {
+            if(bOpen)
+                FlushColumn(first, low, iLow, high, iHigh, last);
+            bOpen = false;
+            linePoints.append(point);
+            continue;
+        }
+        int pointColumn;
+        if(point.x() < Pf.left)
+            pointColumn = INT_MIN;
+        else if(point.x() > Pf.right)
+            pointColumn = INT_MAX;
+        else
+            pointColumn = int(point.x());
+        if(bOpen && (pointColumn == column)) {
+            if(point.y() < low.y())  { low  = point; iLow  = i; }
+            if(point.y() > high.y()) { high = point; iHigh = i; }
+            last = point;
+            continue;
+        }
+        if(bOpen)
+            FlushColumn(first, low, iLow, high, iHigh, last);
+        first = low = high = last = point;
+        iLow = iHigh = i;
+        column = pointColumn;
+        bOpen = true;
+    }
+    if(bOpen)
+        FlushColumn(first, low, iLow, high, iHigh, last);
+}
+
+
+void
+PlotRenderer::FlushColumn(QPointF first, QPointF low, int iLow, QPointF high, int iHigh, QPointF last) {
+    linePoints.append(first);
+    QPointF extreme1 = iLow < iHigh ? low  : high;
+    QPointF extreme2 = iLow < iHigh ? high : low;
+    if(extreme1 != linePoints.last())
+        linePoints.append(extreme1);
+    if(extreme2 != linePoints.last())
+        linePoints.append(extreme2);
+    if(last != linePoints.last())
+        linePoints.append(last);
+}
+
+
+double
+PlotRenderer::NewestX() const {
+    double newest = -DBL_MAX;
+    for(int pos=0; pos<dataSetList.count(); pos++) {
+        DataStream2D* pData = dataSetList.at(pos);
+        if(pData->isShown && (pData->count() > 0))
+            newest = qMax(newest, pData->x(pData->count()-1));
+    }
+    return newest;
+}
+
+
+void
+PlotRenderer::LinePlot(QPainter* painter, DataStream2D* pData, int iFirst) {
+    if(!pData->isShown) return;
+    if(pData->count() <= iFirst) return;
+    QPen dataPen = QPen(pData->GetProperties().Color);
+    dataPen.setWidth(pData->GetProperties().PenWidth);
+    painter->setPen(dataPen);
+
+    // Beyond the ring buffer the samples come from the history
+    if((iFirst == 0) && pData->history() && (Ax.XMin < pData->x(0)))
+        MapHistory(pData);
+    else
+        MapSeries(pData, iFirst);
+    DecimateLine();
+    // One polyline per run of representable points
+    const QPointF* pPoint = linePoints.constData();
+    int iMax = linePoints.count();
+    int iStart = 0;
+    for(int i=0; i<=iMax; i++) {
+        if((i == iMax) || qIsNaN(pPoint[i].x()) || qIsNaN(pPoint[i].y())) {
+            if(i-iStart > 1)
+                painter->drawPolyline(pPoint+iStart, i-iStart);
+            iStart = i+1;
+        }
+    }
+    DrawLastPoint(painter, pData);
+}
+
+
+// To be called just after MapSeries()
+void
+PlotRenderer::DrawLastPoint(QPainter* painter, DataStream2D* pData) {
+    if(!pData->isShown) return;
+    if(screenPoints.isEmpty()) return;
+    const QPointF& point = screenPoints.last();
+    if(point.x()<=Pf.right && point.x()>=Pf.left && point.y()>=Pf.top && point.y()<=Pf.bottom)
+        painter->drawPoint(point);
+}
+
+
+void
+PlotRenderer::PointPlot(QPainter* painter, DataStream2D* pData, int iFirst) {
+    if(pData->count() <= iFirst) return;
+    QPen dataPen = QPen(pData->GetProperties().Color);
+    dataPen.setWidth(pData->GetProperties().PenWidth);
+    painter->setPen(dataPen);
+    MapSeries(pData, iFirst);
+    int nInside = ClipPoints();
+    if(nInside > 0)
+        painter->drawPoints(screenPoints.constData(), nInside);
+}
+
+
+// Raster targets (the widget, a QImage) blit a marker pre-rendered in
+// the sprite atlas for every point; vector targets (SVG) keep the strokes.
+void
+PlotRenderer::ScatterPlot(QPainter* painter, DataStream2D* pData, int iFirst) {
+    if(pData->count() <= iFirst) return;
+    QPen dataPen = QPen(pData->GetProperties().Color);
+    dataPen.setWidth(pData->GetProperties().PenWidth);
+    painter->setPen(dataPen);
+    MapSeries(pData, iFirst);
+    int nInside = ClipPoints();
+    if(nInside == 0) return;
+
+    int symbol = pData->GetProperties().Symbol;
+    QPaintEngine* pEngine = painter->paintEngine();
+    if(pEngine && (pEngine->type() == QPaintEngine::Raster)) {
+        DrawSprites(painter, dataPen, symbol, nInside);
+        return;
+    }
+    const QPointF* pPoint = screenPoints.constData();
+    if(symbol == icircle) {
+        for(int i=0; i<nInside; i++)
+            painter->drawEllipse(pPoint[i], symbolHalfSize, symbolHalfSize);
+        return;
+    }
+    // All the symbols of the series go in a single drawLines()
+    symbolLines.clear();
+    for(int i=0; i<nInside; i++)
+        AppendSymbol(symbol, pPoint[i]);
+    painter->drawLines(symbolLines.constData(), symbolLines.count());
+}
+
+
+// The strokes of a symbol (but the circle) centered on point
+void
+PlotRenderer::AppendSymbol(int symbol, QPointF point) {
+    const double h = symbolHalfSize;
+    double ix = point.x();
+    double iy = point.y();
+    if(symbol == iplus) {
+        symbolLines.append(QLineF(ix, iy-h, ix, iy+h+1));
+        symbolLines.append(QLineF(ix-h, iy, ix+h+1, iy));
+    } else if(symbol == iper) {
+        symbolLines.append(QLineF(ix-h+1, iy+h-1, ix+h-1, iy-h));
+        symbolLines.append(QLineF(ix+h-1, iy+h-1, ix-h+1, iy-h));
+    } else if(symbol == istar) {
+        symbolLines.append(QLineF(ix, iy-h, ix, iy+h+1));
+        symbolLines.append(QLineF(ix-h, iy, ix+h+1, iy));
+        symbolLines.append(QLineF(ix-h+1, iy+h-1, ix+h-1, iy-h));
+        symbolLines.append(QLineF(ix+h-1, iy+h-1, ix-h+1, iy-h));
+    } else if(symbol == iuptriangle) {
+        symbolLines.append(QLineF(ix, iy-h, ix+h, iy+h));
+        symbolLines.append(QLineF(ix+h, iy+h, ix-h, iy+h));
+        symbolLines.append(QLineF(ix-h, iy+h, ix, iy-h));
+    } else if(symbol == idntriangle) {
+        symbolLines.append(QLineF(ix, iy+h, ix+h, iy-h));
+        symbolLines.append(QLineF(ix+h, iy-h, ix-h, iy-h));
+        symbolLines.append(QLineF(ix-h, iy-h, ix, iy+h));
+    } else {
+        symbolLines.append(QLineF(ix-h, iy, ix-h, iy-2*h));
+        symbolLines.append(QLineF(ix, iy-h, ix-2*h, iy-h));
+    }
+}
+
+
+// The first nPoints of screenPoints, one sprite each. From the GUI
+// thread a single drawPixmapFragments(); elsewhere (QPixmap is not
+// thread safe) a drawImage() per point from the same atlas.
+void
+PlotRenderer::DrawSprites(QPainter* painter, const QPen& pen, int symbol, int nPoints) {
+    qreal ratio = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    QRect source = SpriteRect(pen, symbol, ratio);
+    const QPointF* pPoint = screenPoints.constData();
+    QCoreApplication* pApplication = QCoreApplication::instance();
+    if(pApplication && (QThread::currentThread() == pApplication->thread())) {
+        if(bAtlasPixmapDirty) {
+            symbolAtlasPixmap = QPixmap::fromImage(symbolAtlas);
+            bAtlasPixmapDirty = false;
+        }
+        // The fragments are scaled back to logical pixels
+        fragments.resize(nPoints);
+        QPainter::PixmapFragment* pFragment = fragments.data();
+        for(int i=0; i<nPoints; i++)
+            pFragment[i] = QPainter::PixmapFragment::create(pPoint[i], source, 1.0/ratio, 1.0/ratio);
+        painter->drawPixmapFragments(pFragment, nPoints, symbolAtlasPixmap);
+        return;
+    }
+    double half = 0.5*source.width()/ratio;
+    for(int i=0; i<nPoints; i++)
+        painter->drawImage(QRectF(pPoint[i].x()-half, pPoint[i].y()-half, 2.0*half, 2.0*half),
+                           symbolAtlas, source);
+}
+
+
+// Where the sprite of a symbol, color and pen width lies in the atlas
+// (in its device pixels). A missing sprite is rendered once: the atlas
+// is redrawn with all its sprites, a few per plot.
+QRect
+PlotRenderer::SpriteRect(const QPen& pen, int symbol, qreal ratio) {
+    if(ratio != atlasRatio) {
+        sprites.clear();
+        atlasRatio = ratio;
+    }
+    quint64 key = (quint64(pen.color().rgba()) << 16) |
+                  (quint64(pen.width() & 0xff) << 8) |
+                   quint64(symbol & 0xff);
+    for(int i=0; i<sprites.count(); i++) {
+        if(sprites.at(i).key == key)
+            return sprites.at(i).rect;
+    }
+    Sprite sprite;
+    sprite.key    = key;
+    sprite.pen    = pen;
+    sprite.symbol = symbol;
+    sprites.append(sprite);
+
+    // Square cells, the symbol centered: the widest one reaches 2h+1
+    // from its center, plus the pen
+    int width = 0;
+    int height = 0;
+    for(int i=0; i<sprites.count(); i++) {
+        double half = 2.0*symbolHalfSize + 2.0 + sprites.at(i).pen.width();
+        int cell = int(ceil(2.0*half*ratio));
+        sprites[i].rect = QRect(width, 0, cell, cell);
+        width += cell;
+        height = qMax(height, cell);
+    }
+    symbolAtlas = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+    symbolAtlas.fill(Qt::transparent);
+    symbolAtlas.setDevicePixelRatio(ratio);
+    QPainter atlasPainter(&symbolAtlas);
+    for(int i=0; i<sprites.count(); i++) {
+        const Sprite& cell = sprites.at(i);
+        QPointF center = QRectF(cell.rect).center()/ratio;
+        atlasPainter.setPen(cell.pen);
+        if(cell.symbol == icircle) {
+            atlasPainter.drawEllipse(center, symbolHalfSize, symbolHalfSize);
+        }
+        else {
+            symbolLines.clear();
+            AppendSymbol(cell.symbol, center);
+            atlasPainter.drawLines(symbolLines.constData(), symbolLines.count());
+        }
+    }
+    atlasPainter.end();
+    bAtlasPixmapDirty = true;
+    return sprites.last().rect;
+}
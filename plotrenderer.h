@@ -0,0 +1,113 @@
+#pragma once
+
+#include "datastream2d.h"
+#include "AxisLimits.h"
+#include "AxisFrame.h"
+#include "screentransform.h"
+
+#include <QList>
+#include <QVector>
+#include <QPointF>
+#include <QLineF>
+#include <QPen>
+#include <QSize>
+#include <QString>
+#include <QFontMetrics>
+#include <QImage>
+#include <QPixmap>
+#include <QPainter>
+
+
+// The drawing of a Plot2D (frame, ticks, labels and series) apart from
+// the widget: it paints on any QPaintDevice (a QImage, a QSvgGenerator,
+// ...) and, holding no QObject, it may be used from any thread.
+// The Data Sets are not owned.
+class PlotRenderer
+{
+public:
+    static const int iline       = 0;
+    static const int ipoint      = 1;
+    static const int iplus       = 2;
+    static const int iper        = 3;
+    static const int istar       = 4;
+    static const int iuptriangle = 5;
+    static const int idntriangle = 6;
+    static const int icircle     = 7;
+
+    PlotRenderer();
+    virtual ~PlotRenderer();
+    void SetLimits (double XMin, double XMax, double YMin, double YMax,
+                    bool AutoX, bool AutoY, bool LogX, bool LogY);
+    void SetPens(QPen newLabelPen, QPen newGridPen, QPen newFramePen);
+    void SetPlotTitle(QString sNewTitle);
+    void AddDataSet(DataStream2D* pData);
+    // The whole plot on a canvas of the given size
+    void Render(QPainter* painter, QSize size, QColor background);
+
+protected:
+    void SetFrame(QSize size, QFontMetrics fontMetrics);
+    void DrawFrame(QPainter* painter, QFontMetrics fontMetrics);
+    void XTicLin(QPainter* painter, QFontMetrics fontMetrics);
+    void XTicLog(QPainter* painter, QFontMetrics fontMetrics);
+    void YTicLin(QPainter* painter, QFontMetrics fontMetrics);
+    void YTicLog(QPainter* painter, QFontMetrics fontMetrics);
+    void DrawData(QPainter* painter, QFontMetrics fontMetrics);
+    void AutoScale();
+    void SyncLogCache();
+    static bool AutoRange(double dataMin, double dataMax, bool bLog, double* pMin, double* pMax);
+    void DrawSeries(QPainter* painter, DataStream2D* pData, int iFirst);
+    double NewestX() const;
+    AxisMapping XMapping() const;
+    AxisMapping YMapping() const;
+    void MapSeries(DataStream2D* pData, int iFirst);
+    void MapHistory(DataStream2D* pData);
+    void MapWorldPoints();
+    int  ClipPoints();
+    void LinePlot(QPainter* painter, DataStream2D* pData, int iFirst);
+    void DecimateLine();
+    void FlushColumn(QPointF first, QPointF low, int iLow, QPointF high, int iHigh, QPointF last);
+    void PointPlot(QPainter* painter, DataStream2D* pData, int iFirst);
+    void ScatterPlot(QPainter* painter, DataStream2D* pData, int iFirst);
+    void AppendSymbol(int symbol, QPointF point);
+    void DrawSprites(QPainter* painter, const QPen& pen, int symbol, int nPoints);
+    QRect SpriteRect(const QPen& pen, int symbol, qreal ratio);
+    void DrawLastPoint(QPainter* painter, DataStream2D* pData);
+    void ShowTitle(QPainter* painter, QFontMetrics fontMetrics, DataStream2D* pData);
+    // Hooks for the widget
+    virtual bool IsScrolling() const;  // X ticks drawn apart, at every paint
+    virtual bool IsDrawnElsewhere(DataStream2D* pData) const;
+
+protected:
+    QList<DataStream2D*> dataSetList;
+    QPen labelPen;
+    QPen gridPen;
+    QPen framePen;
+    AxisLimits Ax;
+    AxisFrame Pf;
+    QSize canvas;
+    QString sTitle;
+    double xfact, yfact;
+    bool bBoundsDirty;  // Samples added or removed since the last AutoScale()
+
+    // Reused at every paint: no allocations once grown
+    QVector<QPointF> screenPoints; // The series being drawn, in pixels
+    QVector<QPointF> linePoints;   // Decimated vertices
+    QVector<double>  historyX;     // The history buckets being drawn
+    QVector<double>  historyY;
+    QVector<double>  yBuffer;      // Float values widened for the mapping
+    QVector<QLineF>  symbolLines;
+
+    // Scatter markers, each symbol, color and pen width rendered once
+    struct Sprite {
+        quint64 key;
+        QPen    pen;
+        int     symbol;
+        QRect   rect;   // In the atlas device pixels
+    };
+    QVector<Sprite> sprites;
+    QImage  symbolAtlas;
+    QPixmap symbolAtlasPixmap; // GUI thread copy, for drawPixmapFragments()
+    qreal   atlasRatio;
+    bool    bAtlasPixmapDirty;
+    QVector<QPainter::PixmapFragment> fragments;
+};
@@ -0,0 +1,81 @@
+#include "renderscheduler.h"
+
+#include <QWidget>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QCoreApplication>
+#include <QEvent>
+
+
+// Queued below the (low priority) UpdateRequest of the repaints
+static const QEvent::Type framePaintedEvent = QEvent::Type(QEvent::registerEventType());
+
+
+RenderScheduler::RenderScheduler(QObject *parent)
+    : QObject(parent)
+    , frameRate(60)
+{
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer, SIGNAL(timeout()),
+            this, SLOT(onFrameTick()));
+    setRefreshRate(frameRate);
+}
+
+
+void
+RenderScheduler::setRefreshRate(int hz) {
+    if(hz < 1) hz = 1;
+    // No point in painting faster than the display
+    QScreen* pScreen = QGuiApplication::primaryScreen();
+    if(pScreen && (pScreen->refreshRate() > 1.0))
+        hz = qMin(hz, qRound(pScreen->refreshRate()));
+    frameRate = hz;
+    frameTimer.setInterval(1000/frameRate);
+}
+
+
+int
+RenderScheduler::refreshRate() const {
+    return frameRate;
+}
+
+
+void
+RenderScheduler::markDirty(QWidget* pWidget) {
+    if(!dirtyWidgets.contains(pWidget))
+        dirtyWidgets.append(pWidget);
+}
+
+
+void
+RenderScheduler::start() {
+    frameTimer.start();
+}
+
+
+void
+RenderScheduler::stop() {
+    frameTimer.stop();
+}
+
+
+void
+RenderScheduler::onFrameTick() {
+    emit frameStarted();
+    if(dirtyWidgets.isEmpty())
+        return;
+    for(int i=0; i<dirtyWidgets.count(); i++)
+        dirtyWidgets.at(i)->update();
+    dirtyWidgets.clear();
+    QCoreApplication::postEvent(this, new QEvent(framePaintedEvent),
+                                Qt::LowEventPriority-1);
+}
+
+
+void
+RenderScheduler::customEvent(QEvent* event) {
+    if(event->type() == framePaintedEvent)
+        emit frameRendered();
+    else
+        QObject::customEvent(event);
+}
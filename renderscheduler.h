@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+
+QT_FORWARD_DECLARE_CLASS(QWidget)
+
+
+// Coalesces the repaint requests of the telemetry driven widgets:
+// widgets are only marked dirty and they are repainted (at most once)
+// at every frame tick. The tick rate is capped to the display refresh.
+class RenderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RenderScheduler(QObject *parent = nullptr);
+    void setRefreshRate(int hz);
+    int  refreshRate() const;
+    void markDirty(QWidget* pWidget);
+    void start();
+    void stop();
+
+signals:
+    // Emitted at each tick just before the dirty widgets are repainted
+    void frameStarted();
+    // Emitted once the repaints requested at the last tick have been done
+    void frameRendered();
+
+protected:
+    void customEvent(QEvent* event);
+
+private slots:
+    void onFrameTick();
+
+private:
+    QTimer            frameTimer;
+    QVector<QWidget*> dirtyWidgets;
+    int               frameRate;
+};
@@ -0,0 +1,318 @@
+#include "screentransform.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCREENTRANSFORM_X86
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+
+const double log10Of2 = 0.30102999566398119521;
+const double log10OfE = 0.43429448190325182765;
+const double sqrt2    = 1.41421356237309504880;
+
+
+// log10(x) = e*log10(2) + ln(m)*log10(e), with x = m*2^e, m in [sqrt(2)/2, sqrt(2))
+// and ln(m) = 2*atanh(t) = 2*(t + t^3/3 + ... + t^11/11), t = (m-1)/(m+1)
+inline double
+scalarLog10(double x) {
+    if(!(x > 0.0))
+        return NAN;
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    double e = double(int64_t((bits >> 52) & 0x7FF) - 1023);
+    bits = (bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull;
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+    if(m > sqrt2) {
+        m *= 0.5;
+        e += 1.0;
+    }
+    double t  = (m-1.0)/(m+1.0);
+    double t2 = t*t;
+    double p  = 1.0/11.0;
+    p = p*t2 + 1.0/9.0;
+    p = p*t2 + 1.0/7.0;
+    p = p*t2 + 1.0/5.0;
+    p = p*t2 + 1.0/3.0;
+    p = p*t2 + 1.0;
+    return e*log10Of2 + (2.0*t*p)*log10OfE;
+}
+
+
+inline double
+scalarMap(double value, const AxisMapping& map) {
+    if(map.bLog)
+        value = scalarLog10(value);
+    return (value-map.origin)*map.scale + map.offset;
+}
+
+
+void
+scalarPoints(const double* pX, const double* pY, size_t n,
+             const AxisMapping& xMap, const AxisMapping& yMap, double* pXY)
+{
+    for(size_t i=0; i<n; i++) {
+        pXY[2*i]   = scalarMap(pX[i], xMap);
+        pXY[2*i+1] = scalarMap(pY[i], yMap);
+    }
+}
+
+
+void
+scalarValues(const double* pIn, size_t n, const AxisMapping& map, double* pOut) {
+    for(size_t i=0; i<n; i++)
+        pOut[i] = scalarMap(pIn[i], map);
+}
+
+
+#ifdef SCREENTRANSFORM_X86
+
+// The same computation, operation by operation, of scalarLog10():
+// no FMA contraction so that all the instruction sets agree.
+
+inline __m128d
+sse2Log10(__m128d x) {
+    __m128i bits = _mm_castpd_si128(x);
+    // Exponent as double: (biased exponent | 2^52 bits) - 2^52 - 1023
+    __m128i biased = _mm_srli_epi64(bits, 52);
+    biased = _mm_and_si128(biased, _mm_set1_epi64x(0x7FF));
+    __m128d e = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(biased, _mm_set1_epi64x(0x4330000000000000ll))),
+                           _mm_set1_pd(4503599627370496.0 + 1023.0));
+    __m128i mBits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000FFFFFFFFFFFFFll)),
+                                 _mm_set1_epi64x(0x3FF0000000000000ll));
+    __m128d m = _mm_castsi128_pd(mBits);
+    __m128d big = _mm_cmpgt_pd(m, _mm_set1_pd(sqrt2));
+    m = _mm_or_pd(_mm_and_pd(big, _mm_mul_pd(m, _mm_set1_pd(0.5))), _mm_andnot_pd(big, m));
+    e = _mm_add_pd(e, _mm_and_pd(big, _mm_set1_pd(1.0)));
+    __m128d one = _mm_set1_pd(1.0);
+    __m128d t   = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+    __m128d t2  = _mm_mul_pd(t, t);
+    __m128d p   = _mm_set1_pd(1.0/11.0);
+    p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/9.0));
+    p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/7.0));
+    p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/5.0));
+    p = _mm_add_pd(_mm_mul_pd(p, t2), _mm_set1_pd(1.0/3.0));
+    p = _mm_add_pd(_mm_mul_pd(p, t2), one);
+    __m128d ln = _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(2.0), t), p);
+    __m128d result = _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(log10Of2)),
+                                _mm_mul_pd(ln, _mm_set1_pd(log10OfE)));
+    // NaN where !(x > 0)
+    __m128d positive = _mm_cmpgt_pd(x, _mm_setzero_pd());
+    return _mm_or_pd(_mm_and_pd(positive, result),
+                     _mm_andnot_pd(positive, _mm_set1_pd(NAN)));
+}
+
+
+inline __m128d
+sse2Map(__m128d value, const AxisMapping& map) {
+    if(map.bLog)
+        value = sse2Log10(value);
+    return _mm_add_pd(_mm_mul_pd(_mm_sub_pd(value, _mm_set1_pd(map.origin)),
+                                 _mm_set1_pd(map.scale)),
+                      _mm_set1_pd(map.offset));
+}
+
+
+void
+sse2Points(const double* pX, const double* pY, size_t n,
+           const AxisMapping& xMap, const AxisMapping& yMap, double* pXY)
+{
+    size_t i = 0;
+    for(; i+2<=n; i+=2) {
+        __m128d x = sse2Map(_mm_loadu_pd(pX+i), xMap);
+        __m128d y = sse2Map(_mm_loadu_pd(pY+i), yMap);
+        _mm_storeu_pd(pXY+2*i,   _mm_unpacklo_pd(x, y));
+        _mm_storeu_pd(pXY+2*i+2, _mm_unpackhi_pd(x, y));
+    }
+    scalarPoints(pX+i, pY+i, n-i, xMap, yMap, pXY+2*i);
+}
+
+
+void
+sse2Values(const double* pIn, size_t n, const AxisMapping& map, double* pOut) {
+    size_t i = 0;
+    for(; i+2<=n; i+=2)
+        _mm_storeu_pd(pOut+i, sse2Map(_mm_loadu_pd(pIn+i), map));
+    scalarValues(pIn+i, n-i, map, pOut+i);
+}
+
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+
+AVX2_TARGET inline __m256d
+avx2Log10(__m256d x) {
+    __m256i bits = _mm256_castpd_si256(x);
+    __m256i biased = _mm256_and_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x7FF));
+    __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(biased, _mm256_set1_epi64x(0x4330000000000000ll))),
+                              _mm256_set1_pd(4503599627370496.0 + 1023.0));
+    __m256i mBits = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFll)),
+                                    _mm256_set1_epi64x(0x3FF0000000000000ll));
+    __m256d m = _mm256_castsi256_pd(mBits);
+    __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(sqrt2), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+    e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d t   = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d t2  = _mm256_mul_pd(t, t);
+    __m256d p   = _mm256_set1_pd(1.0/11.0);
+    p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/9.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/7.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/5.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, t2), _mm256_set1_pd(1.0/3.0));
+    p = _mm256_add_pd(_mm256_mul_pd(p, t2), one);
+    __m256d ln = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(2.0), t), p);
+    __m256d result = _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(log10Of2)),
+                                   _mm256_mul_pd(ln, _mm256_set1_pd(log10OfE)));
+    __m256d positive = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ);
+    return _mm256_blendv_pd(_mm256_set1_pd(NAN), result, positive);
+}
+
+
+AVX2_TARGET inline __m256d
+avx2Map(__m256d value, const AxisMapping& map) {
+    if(map.bLog)
+        value = avx2Log10(value);
+    return _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(value, _mm256_set1_pd(map.origin)),
+                                       _mm256_set1_pd(map.scale)),
+                         _mm256_set1_pd(map.offset));
+}
+
+
+AVX2_TARGET void
+avx2Points(const double* pX, const double* pY, size_t n,
+           const AxisMapping& xMap, const AxisMapping& yMap, double* pXY)
+{
+    size_t i = 0;
+    for(; i+4<=n; i+=4) {
+        __m256d x  = avx2Map(_mm256_loadu_pd(pX+i), xMap);
+        __m256d y  = avx2Map(_mm256_loadu_pd(pY+i), yMap);
+        __m256d lo = _mm256_unpacklo_pd(x, y); // x0 y0 x2 y2
+        __m256d hi = _mm256_unpackhi_pd(x, y); // x1 y1 x3 y3
+        _mm256_storeu_pd(pXY+2*i,   _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd(pXY+2*i+4, _mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+    scalarPoints(pX+i, pY+i, n-i, xMap, yMap, pXY+2*i);
+}
+
+
+AVX2_TARGET void
+avx2Values(const double* pIn, size_t n, const AxisMapping& map, double* pOut) {
+    size_t i = 0;
+    for(; i+4<=n; i+=4)
+        _mm256_storeu_pd(pOut+i, avx2Map(_mm256_loadu_pd(pIn+i), map));
+    scalarValues(pIn+i, n-i, map, pOut+i);
+}
+
+#endif // SCREENTRANSFORM_X86
+
+
+ScreenTransform::InstructionSet
+detectInstructionSet() {
+#ifdef SCREENTRANSFORM_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return ScreenTransform::Avx2;
+    if(__builtin_cpu_supports("sse2"))
+        return ScreenTransform::Sse2;
+#endif
+    return ScreenTransform::Scalar;
+}
+
+
+ScreenTransform::InstructionSet currentSet = detectInstructionSet();
+
+
+} // namespace
+
+
+ScreenTransform::InstructionSet
+ScreenTransform::bestInstructionSet() {
+    return detectInstructionSet();
+}
+
+
+ScreenTransform::InstructionSet
+ScreenTransform::instructionSet() {
+    return currentSet;
+}
+
+
+void
+ScreenTransform::setInstructionSet(InstructionSet newSet) {
+    InstructionSet best = bestInstructionSet();
+    currentSet = newSet > best ? best : newSet;
+}
+
+
+const char*
+ScreenTransform::name(InstructionSet set) {
+    switch(set) {
+    case Avx2: return "AVX2";
+    case Sse2: return "SSE2";
+    default:   return "Scalar";
+    }
+}
+
+
+void
+ScreenTransform::mapPoints(const double* pX, const double* pY, size_t n,
+                           const AxisMapping& xMap, const AxisMapping& yMap,
+                           double* pXY)
+{
+#ifdef SCREENTRANSFORM_X86
+    if(currentSet == Avx2) {
+        avx2Points(pX, pY, n, xMap, yMap, pXY);
+        return;
+    }
+    if(currentSet == Sse2) {
+        sse2Points(pX, pY, n, xMap, yMap, pXY);
+        return;
+    }
+#endif
+    scalarPoints(pX, pY, n, xMap, yMap, pXY);
+}
+
+
+void
+ScreenTransform::mapValues(const double* pIn, size_t n,
+                           const AxisMapping& map, double* pOut)
+{
+#ifdef SCREENTRANSFORM_X86
+    if(currentSet == Avx2) {
+        avx2Values(pIn, n, map, pOut);
+        return;
+    }
+    if(currentSet == Sse2) {
+        sse2Values(pIn, n, map, pOut);
+        return;
+    }
+#endif
+    scalarValues(pIn, n, map, pOut);
+}
+
+
+double
+ScreenTransform::toPixel(double value, const AxisMapping& map) {
+    return scalarMap(value, map);
+}
+
+
+double
+ScreenTransform::toWorld(double pixel, const AxisMapping& map) {
+    double value = (pixel-map.offset)/map.scale + map.origin;
+    return map.bLog ? pow(10.0, value) : value;
+}
+
+
+double
+ScreenTransform::fastLog10(double x) {
+    return scalarLog10(x);
+}
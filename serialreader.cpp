@@ -0,0 +1,119 @@
+#include "serialreader.h"
+#include "latencystats.h"
+
+
+SerialReader::SerialReader(TelemetryRing* pTelemetryRing, QObject *parent)
+    : QObject(parent)
+    , ingest(pTelemetryRing)
+    , nBytes(0)
+{
+    // Child of this, so it will follow us in moveToThread()
+    pSerialPort = new QSerialPort(this);
+    connect(pSerialPort, SIGNAL(readyRead()),
+            this, SLOT(onReadyRead()));
+    connect(pSerialPort, SIGNAL(errorOccurred(QSerialPort::SerialPortError)),
+            this, SLOT(onErrorOccurred(QSerialPort::SerialPortError)));
+}
+
+
+SerialReader::~SerialReader() {
+    if(pSerialPort->isOpen())
+        pSerialPort->close();
+}
+
+
+quint64
+SerialReader::bytesReceived() const {
+    return nBytes.load(std::memory_order_relaxed);
+}
+
+
+quint64
+SerialReader::framesReceived() const {
+    return ingest.framesReceived();
+}
+
+
+quint64
+SerialReader::droppedRecords() const {
+    return ingest.droppedRecords();
+}
+
+
+quint64
+SerialReader::corruptedRecords() const {
+    return ingest.corruptedRecords();
+}
+
+
+void
+SerialReader::setBinaryFraming(bool bRequested) {
+    ingest.setBinaryRequested(bRequested);
+}
+
+
+void
+SerialReader::openPort(QString sPortName, int baudRate) {
+    if(pSerialPort->isOpen())
+        pSerialPort->close();
+    pSerialPort->setPortName(sPortName);
+    if(!pSerialPort->open(QIODevice::ReadWrite)) {
+        emit portOpened(false);
+        return;
+    }
+    pSerialPort->setBaudRate(baudRate);
+    pSerialPort->readAll(); // Discard Input Buffer
+    ingest.reset(); // Every session starts in text mode
+    emit portOpened(true);
+}
+
+
+void
+SerialReader::closePort() {
+    if(pSerialPort->isOpen())
+        pSerialPort->close();
+}
+
+
+void
+SerialReader::setBaudRate(int baudRate) {
+    if(pSerialPort->isOpen())
+        pSerialPort->setBaudRate(baudRate);
+}
+
+
+void
+SerialReader::onErrorOccurred(QSerialPort::SerialPortError error) {
+    // The device has been unplugged (or has otherwise disappeared)
+    if(error == QSerialPort::ResourceError) {
+        if(pSerialPort->isOpen())
+            pSerialPort->close();
+        emit portLost();
+    }
+}
+
+
+void
+SerialReader::write(QByteArray data) {
+    if(pSerialPort->isOpen())
+        pSerialPort->write(data);
+}
+
+
+void
+SerialReader::onReadyRead() {
+    // Read straight into the framer ring and parse straight into the
+    // telemetry ring: no per line copies
+    for(;;) {
+        size_t nFree;
+        char* pFree = ingest.writeBuffer(&nFree);
+        qint64 nRead = pSerialPort->read(pFree, qint64(nFree));
+        if(nRead <= 0)
+            break;
+        nBytes.fetch_add(quint64(nRead), std::memory_order_relaxed);
+        ingest.commit(size_t(nRead), monotonicNs());
+        const char* pReply = ingest.takeReply();
+        if(pReply)
+            pSerialPort->write(pReply);
+    }
+}
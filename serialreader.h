@@ -0,0 +1,45 @@
+#pragma once
+
+#include "telemetryingest.h"
+
+#include <QObject>
+#include <QSerialPort>
+#include <QByteArray>
+#include <atomic>
+
+
+// Lives in its own thread: owns the serial port and feeds the incoming
+// bytes to a TelemetryIngest, publishing into the ring drained by the
+// GUI thread.
+class SerialReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialReader(TelemetryRing* pTelemetryRing, QObject *parent = nullptr);
+    ~SerialReader();
+    quint64 bytesReceived() const;
+    quint64 framesReceived() const;
+    quint64 droppedRecords() const;
+    quint64 corruptedRecords() const;
+
+public slots:
+    void openPort(QString sPortName, int baudRate);
+    void closePort();
+    void setBaudRate(int baudRate);
+    void write(QByteArray data);
+    void setBinaryFraming(bool bRequested);
+
+signals:
+    void portOpened(bool bSuccess);
+    void portLost();
+
+private slots:
+    void onReadyRead();
+    void onErrorOccurred(QSerialPort::SerialPortError error);
+
+private:
+    QSerialPort*         pSerialPort;
+    TelemetryIngest      ingest;
+    std::atomic<quint64> nBytes;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+
+// Bounded, lock-free, Single-Producer/Single-Consumer ring.
+// head is written only by the producer, tail only by the consumer.
+// Both are free running counters, so all the Capacity slots are usable.
+template<typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert((Capacity & (Capacity-1)) == 0,
+                  "SpscRing Capacity must be a power of two");
+
+public:
+    SpscRing()
+        : head(0)
+        , tail(0)
+    {
+    }
+
+    // Producer side: the slot returned (if any) is published by endPush()
+    T* beginPush() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h - tail.load(std::memory_order_acquire) == Capacity)
+            return nullptr; // Ring Full
+        return &buffer[h & (Capacity-1)];
+    }
+
+    void endPush() {
+        head.store(head.load(std::memory_order_relaxed)+1,
+                   std::memory_order_release);
+    }
+
+    bool push(const T& item) {
+        T* pSlot = beginPush();
+        if(!pSlot) return false;
+        *pSlot = item;
+        endPush();
+        return true;
+    }
+
+    // Consumer side: the slot returned (if any) is released by pop()
+    const T* front() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(head.load(std::memory_order_acquire) == t)
+            return nullptr; // Ring Empty
+        return &buffer[t & (Capacity-1)];
+    }
+
+    void pop() {
+        tail.store(tail.load(std::memory_order_relaxed)+1,
+                   std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) -
+               tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    alignas(64) T buffer[Capacity];
+};
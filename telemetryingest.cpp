@@ -0,0 +1,195 @@
+#include "telemetryingest.h"
+#include "binarytelemetry.h"
+#include "latencystats.h"
+
+#include <string.h>
+
+
+// Too many bad records in a row: the Buggy is (again) talking plain text
+static const int maxConsecutiveErrors = 8;
+// As many bytes without a good record: the Buggy was reset and talks
+// plain text (which has no 0x00 delimiters to count errors on)
+static const size_t maxBinarySilence = 64*BinaryTelemetry::maxEncodedSize;
+static const char buggyReady[] = "Buggy Ready\n";
+
+
+TelemetryIngest::TelemetryIngest(TelemetryRing* pTelemetryRing)
+    : pRing(pTelemetryRing)
+    , bBinaryRequested(false)
+    , bBinaryMode(false)
+    , nConsecutiveErrors(0)
+    , nBytesSinceFrame(0)
+    , readyMatched(0)
+    , pReply(nullptr)
+    , nFrames(0)
+    , nDropped(0)
+    , nCorrupted(0)
+{
+}
+
+
+void
+TelemetryIngest::reset() {
+    framer.reset();
+    setBinaryMode(false);
+    pReply = nullptr;
+}
+
+
+void
+TelemetryIngest::setBinaryRequested(bool bRequested) {
+    bBinaryRequested = bRequested;
+}
+
+
+bool
+TelemetryIngest::binaryMode() const {
+    return bBinaryMode;
+}
+
+
+void
+TelemetryIngest::setBinaryMode(bool bBinary) {
+    bBinaryMode = bBinary;
+    nConsecutiveErrors = 0;
+    nBytesSinceFrame = 0;
+    readyMatched = 0;
+    framer.setDelimiter(bBinary ? '\0' : '\n');
+}
+
+
+const char*
+TelemetryIngest::takeReply() {
+    const char* pResult = pReply;
+    pReply = nullptr;
+    return pResult;
+}
+
+
+uint64_t
+TelemetryIngest::framesReceived() const {
+    return nFrames.load(std::memory_order_relaxed);
+}
+
+
+uint64_t
+TelemetryIngest::droppedRecords() const {
+    return nDropped.load(std::memory_order_relaxed);
+}
+
+
+uint64_t
+TelemetryIngest::corruptedRecords() const {
+    return nCorrupted.load(std::memory_order_relaxed);
+}
+
+
+char*
+TelemetryIngest::writeBuffer(size_t* pFree) {
+    return framer.writeBuffer(pFree);
+}
+
+
+void
+TelemetryIngest::absorb(const char* pData, size_t size, int64_t arrivalNs) {
+    while(size) {
+        size_t nFree;
+        char* pFree = framer.writeBuffer(&nFree);
+        if(nFree > size)
+            nFree = size;
+        memcpy(pFree, pData, nFree);
+        commit(nFree, arrivalNs);
+        pData += nFree;
+        size  -= nFree;
+    }
+}
+
+
+// The nBytes just written at writeBuffer() are framed and published
+void
+TelemetryIngest::commit(size_t nBytes, int64_t arrivalNs) {
+    std::string_view line;
+    if(bBinaryMode) {
+        size_t nFree;
+        char* pData = framer.writeBuffer(&nFree);
+        size_t end = findBuggyReady(pData, nBytes);
+        if(end > 0) {
+            // The Buggy restarted in text mode: keep what follows
+            // its announce, framed as text
+            setBinaryMode(false);
+            framer.reset();
+            publish(std::string_view(buggyReady, sizeof(buggyReady)-2), arrivalNs);
+            size_t nRest = nBytes-end;
+            char* pStart = framer.writeBuffer(&nFree);
+            memmove(pStart, pData+end, nRest);
+            framer.commit(nRest);
+            while(framer.nextLine(&line))
+                publish(line, arrivalNs);
+            return;
+        }
+        nBytesSinceFrame += nBytes;
+    }
+    framer.commit(nBytes);
+    while(framer.nextLine(&line))
+        publish(line, arrivalNs);
+    if(bBinaryMode && (nBytesSinceFrame > maxBinarySilence))
+        setBinaryMode(false);
+}
+
+
+// Looks for a whole "Buggy Ready\n" (possibly split among reads) in the
+// binary stream; returns the offset just past it, 0 if not found.
+size_t
+TelemetryIngest::findBuggyReady(const char* pData, size_t size) {
+    const size_t length = sizeof(buggyReady)-1;
+    for(size_t i=0; i<size; i++) {
+        if(pData[i] == buggyReady[readyMatched])
+            readyMatched++;
+        else
+            readyMatched = (pData[i] == buggyReady[0]) ? 1 : 0;
+        if(readyMatched == length) {
+            readyMatched = 0;
+            return i+1;
+        }
+    }
+    return 0;
+}
+
+
+// The frame is decoded apart from the ring, so that the framing state
+// (the binary watchdog, the replies, the mode switches) keeps up also
+// while the ring is full: only the frame itself is then dropped.
+void
+TelemetryIngest::publish(std::string_view line, int64_t arrivalNs) {
+    TelemetryFrame frame;
+    if(bBinaryMode) {
+        if(line.empty())
+            return;
+        if(!BinaryTelemetry::decode(line, &frame)) {
+            nCorrupted.fetch_add(1, std::memory_order_relaxed);
+            if(++nConsecutiveErrors > maxConsecutiveErrors)
+                setBinaryMode(false);
+            return;
+        }
+        nConsecutiveErrors = 0;
+        nBytesSinceFrame = 0;
+    }
+    else {
+        if(!TelemetryParser::parse(line, &frame))
+            return;
+        if((frame.fields & TelemetryFrame::BuggyReady) && bBinaryRequested)
+            pReply = "B\n"; // Ask for the binary framing
+        if(frame.fields & TelemetryFrame::BinaryAck)
+            setBinaryMode(true);  // From the very next byte
+    }
+    TelemetryFrame* pFrame = pRing->beginPush();
+    if(!pFrame) {
+        nDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    *pFrame = frame;
+    pFrame->arrivalNs = arrivalNs;
+    pFrame->parsedNs  = monotonicNs();
+    pRing->endPush();
+    nFrames.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "spscring.h"
+#include "lineframer.h"
+#include "telemetryparser.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+typedef SpscRing<TelemetryFrame, 1024> TelemetryRing;
+
+
+// The producer side of the telemetry, without Qt: frames the bytes read
+// from the Buggy (text lines or, once negotiated, COBS records), parses
+// them and publishes the frames, stamped, into the ring.
+// It also follows the framing: "B\n" is requested at every "Buggy Ready"
+// (when enabled) and the text framing is restored when the Buggy stops
+// talking binary (a reset, a watchdog timeout).
+// SerialReader feeds it from the port, the IngestBenchmark from memory.
+class TelemetryIngest
+{
+public:
+    explicit TelemetryIngest(TelemetryRing* pTelemetryRing);
+    // Empty framer, text mode: a new session
+    void  reset();
+    void  setBinaryRequested(bool bRequested);
+    bool  binaryMode() const;
+    // Bytes are read straight into the framer ring, then committed
+    char* writeBuffer(size_t* pFree);
+    void  commit(size_t nBytes, int64_t arrivalNs);
+    // Copies (in pieces of at most the framer capacity) and commits
+    void  absorb(const char* pData, size_t size, int64_t arrivalNs);
+    // The reply due to the Buggy, if any ("B\n"): to be written by the caller
+    const char* takeReply();
+    // May be read from any thread
+    uint64_t framesReceived() const;
+    uint64_t droppedRecords() const;
+    uint64_t corruptedRecords() const;
+
+protected:
+    void   publish(std::string_view line, int64_t arrivalNs);
+    void   setBinaryMode(bool bBinary);
+    size_t findBuggyReady(const char* pData, size_t size);
+
+private:
+    TelemetryRing* pRing;
+    LineFramer     framer;
+    bool           bBinaryRequested;
+    bool           bBinaryMode;
+    int            nConsecutiveErrors;
+    size_t         nBytesSinceFrame; // Binary mode: since the last good record
+    size_t         readyMatched;     // Bytes of "Buggy Ready\n" seen so far
+    const char*    pReply;
+    std::atomic<uint64_t> nFrames;
+    std::atomic<uint64_t> nDropped;
+    std::atomic<uint64_t> nCorrupted;
+};
@@ -0,0 +1,180 @@
+#include "telemetryparser.h"
+
+#include <charconv>
+#include <string.h>
+
+
+namespace {
+
+
+// Walks the comma separated tokens of a line
+struct Cursor {
+    const char* p;
+    const char* end;
+    bool        bDone;
+
+    bool next(std::string_view* pToken) {
+        if(bDone) return false;
+        const char* pComma = static_cast<const char*>(memchr(p, ',', size_t(end-p)));
+        if(pComma) {
+            *pToken = std::string_view(p, size_t(pComma-p));
+            p = pComma+1;
+        }
+        else {
+            *pToken = std::string_view(p, size_t(end-p));
+            bDone = true;
+        }
+        return true;
+    }
+};
+
+
+inline bool
+isBlank(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+
+// std::from_chars() in the general format (fixed or exponent), after
+// the blanks and an optional '+' as QString::toDouble() accepts them.
+// As QString::toDouble() any malformed token is worth 0.
+double
+toNumber(std::string_view token) {
+    const char* p = token.data();
+    const char* e = p + token.size();
+    while((p < e) && isBlank(*p)) p++;
+    while((e > p) && isBlank(e[-1])) e--;
+    if((p+1 < e) && (*p == '+') && (p[1] != '-') && (p[1] != '+'))
+        p++;
+    double value = 0.0;
+    std::from_chars_result result = std::from_chars(p, e, value, std::chars_format::general);
+    if((result.ec != std::errc()) || (result.ptr != e))
+        return 0.0;
+    return value;
+}
+
+
+// Reads nValues tokens: on a short line the cursor is left untouched
+bool
+readValues(Cursor* pCursor, double* pValues, int nValues) {
+    Cursor start = *pCursor;
+    std::string_view token;
+    for(int i=0; i<nValues; i++) {
+        if(!pCursor->next(&token)) {
+            *pCursor = start;
+            return false;
+        }
+        pValues[i] = toNumber(token);
+    }
+    return true;
+}
+
+
+typedef bool (*RecordParser)(std::string_view header, Cursor* pCursor, TelemetryFrame* pFrame);
+
+
+bool
+parseAttitude(std::string_view header, Cursor* pCursor, TelemetryFrame* pFrame) {
+    double values[4];
+    if((header.size() != 1) || !readValues(pCursor, values, 4))
+        return false;
+    pFrame->q0 = float(values[0]/1000.0);
+    pFrame->q1 = float(values[1]/1000.0);
+    pFrame->q2 = float(values[2]/1000.0);
+    pFrame->q3 = float(values[3]/1000.0);
+    pFrame->fields |= TelemetryFrame::Attitude;
+    return true;
+}
+
+
+bool
+parseMotors(std::string_view header, Cursor* pCursor, TelemetryFrame* pFrame) {
+    double values[4];
+    if((header.size() != 1) || !readValues(pCursor, values, 4))
+        return false;
+    pFrame->leftSpeed  = values[0]/100.0;
+    pFrame->leftPath   = values[1];
+    pFrame->rightSpeed = values[2]/100.0;
+    pFrame->rightPath  = values[3];
+    pFrame->fields |= TelemetryFrame::Motors;
+    return true;
+}
+
+
+bool
+parseObstacle(std::string_view header, Cursor* pCursor, TelemetryFrame* pFrame) {
+    if((header.size() != 1) || !readValues(pCursor, &pFrame->obstacleDistance, 1))
+        return false;
+    pFrame->fields |= TelemetryFrame::Obstacle;
+    return true;
+}
+
+
+bool
+parseTime(std::string_view header, Cursor* pCursor, TelemetryFrame* pFrame) {
+    if((header.size() != 1) || !readValues(pCursor, &pFrame->dTime, 1))
+        return false;
+    pFrame->fields |= TelemetryFrame::Time;
+    return true;
+}
+
+
+bool
+parseParamsRequest(std::string_view header, Cursor* pCursor, TelemetryFrame* pFrame) {
+    (void)pCursor;
+    if(header.size() != 1)
+        return false;
+    pFrame->fields |= TelemetryFrame::ParamsRequest;
+    return true;
+}
+
+
+bool
+parseBuggyState(std::string_view header, Cursor* pCursor, TelemetryFrame* pFrame) {
+    if(header == std::string_view("Buggy Ready"))
+        pFrame->fields |= TelemetryFrame::BuggyReady;
+    else if(header == std::string_view("Buggy Binary"))
+        pFrame->fields |= TelemetryFrame::BinaryAck;
+    else
+        return false;
+    pCursor->bDone = true; // Nothing else is expected on this line
+    return true;
+}
+
+
+struct DispatchTable {
+    RecordParser parser[256];
+
+    DispatchTable() {
+        for(int i=0; i<256; i++)
+            parser[i] = nullptr;
+        parser[int('A')] = parseAttitude;
+        parser[int('M')] = parseMotors;
+        parser[int('D')] = parseObstacle;
+        parser[int('T')] = parseTime;
+        parser[int('P')] = parseParamsRequest;
+        parser[int('B')] = parseBuggyState;
+    }
+};
+
+
+const DispatchTable dispatchTable;
+
+
+} // namespace
+
+
+bool
+TelemetryParser::parse(std::string_view line, TelemetryFrame* pFrame) {
+    pFrame->fields = 0;
+    Cursor cursor = { line.data(), line.data()+line.size(), false };
+    std::string_view header;
+    while(cursor.next(&header)) {
+        if(header.empty())
+            continue;
+        RecordParser parser = dispatchTable.parser[static_cast<unsigned char>(header[0])];
+        if(parser)
+            parser(header, &cursor, pFrame); // Unknown tokens are skipped
+    }
+    return pFrame->fields != 0;
+}
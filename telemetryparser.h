@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+
+
+// All the values carried by a single line sent by the Buggy.
+// Only the values flagged in "fields" are meaningful.
+struct TelemetryFrame {
+    enum Field {
+        Attitude      = 0x01, // A,q0,q1,q2,q3 (x1000)
+        Motors        = 0x02, // M,leftSpeed(x100),leftPath,rightSpeed(x100),rightPath
+        Obstacle      = 0x04, // D,distance
+        Time          = 0x08, // T,milliseconds
+        ParamsRequest = 0x10, // P
+        BuggyReady    = 0x20, // Buggy Ready
+        BinaryAck     = 0x40  // Buggy Binary (see binarytelemetry.h)
+    };
+    unsigned fields;
+    float    q0, q1, q2, q3;
+    double   leftSpeed;
+    double   leftPath;
+    double   rightSpeed;
+    double   rightPath;
+    double   obstacleDistance;
+    double   dTime;
+    int64_t  arrivalNs; // Host CLOCK_MONOTONIC when the record was complete
+    int64_t  parsedNs;  // ... and when it was parsed (see latencystats.h)
+};
+
+
+// Parses directly the bytes of a line without any copy or allocation.
+// The records are dispatched through a table keyed on their first byte.
+class TelemetryParser
+{
+public:
+    static bool parse(std::string_view line, TelemetryFrame* pFrame);
+};